@@ -13,6 +13,8 @@
 #include <atomic>
 #include <mutex>
 #include <gdiplus.h>
+#include "src/backend/include/ImageFilter.h"
+#include "src/backend/include/FlatHashMap.h"
 using namespace Gdiplus;
 
 using namespace std;
@@ -81,10 +83,11 @@ public:
 class HuffmanTree {
 private:
     HuffmanNode* root;
-    unordered_map<wchar_t, wstring> charToCode;  // 字符到编码的映射（文本）
-    unordered_map<wstring, wchar_t> codeToChar;  // 编码到字符的映射（文本）
-    unordered_map<BYTE, wstring> byteToCode;     // 字节到编码的映射（图片）
-    unordered_map<wstring, BYTE> codeToByte;     // 编码到字节的映射（图片）
+    // 码字以 packCodeKey(bits,len) 打包的整数存放，解码逐位累加整数键查表
+    FlatHashMap<uint64_t> charToCode;  // 字符到编码的映射（文本）
+    FlatHashMap<wchar_t> codeToChar;   // 编码到字符的映射（文本）
+    FlatHashMap<uint64_t> byteToCode;  // 字节到编码的映射（图片）
+    FlatHashMap<BYTE> codeToByte;      // 编码到字节的映射（图片）
     vector<HuffmanNode*> leafnodes;
     bool isImageTree;  // 标记当前树是用于图片还是文本
 
@@ -96,6 +99,17 @@ private:
         }
     }
 
+    // 叶子到根回溯得到的码字；int 频率下树深不超过 46，放得进 kMaxPackedCodeLen
+    static uint64_t leafCodeKey(const HuffmanNode* leaf) {
+        uint64_t bits = 0;
+        unsigned len = 0;
+        for (const HuffmanNode* current = leaf; current->parent != nullptr; current = current->parent) {
+            if (current == current->parent->right) bits |= 1ULL << len;
+            ++len;
+        }
+        return packCodeKey(bits, len);
+    }
+
 public:
     HuffmanTree() : root(nullptr), isImageTree(false) {}
     ~HuffmanTree() {
@@ -124,7 +138,6 @@ public:
             HuffmanNode* newNode = new HuffmanNode(p.first, p.second);
             nodes.push_back(newNode);
             leafnodes.push_back(newNode);
-            charToCode[p.first] = L"";
         }
 
         while (nodes.size() > 1) {
@@ -158,17 +171,8 @@ public:
         }
 
         for (size_t i = 0; i < leafnodes.size(); ++i) {
-            HuffmanNode* current = leafnodes[i];
-            wstring code = L"";
-            while (current->parent != nullptr) {
-                if (current == current->parent->left) {
-                    code = L"0" + code;
-                } else {
-                    code = L"1" + code;
-                }
-                current = current->parent;
-            }
             // 文本树：填充字符->编码 和 编码->字符 映射
+            uint64_t code = leafCodeKey(leafnodes[i]);
             wchar_t ch = leafnodes[i]->ch;
             charToCode[ch] = code;
             codeToChar[code] = ch;
@@ -176,27 +180,42 @@ public:
     }
 
     unordered_map<wchar_t, wstring> getCharCodeMap() const {
-        return charToCode;
+        unordered_map<wchar_t, wstring> result;
+        charToCode.forEach([&result](uint64_t ch, uint64_t code) { result[(wchar_t)ch] = codeKeyToString(code); });
+        return result;
     }
 
     unordered_map<BYTE, wstring> getByteCodeMap() const {
-        return byteToCode;
+        unordered_map<BYTE, wstring> result;
+        byteToCode.forEach([&result](uint64_t b, uint64_t code) { result[(BYTE)b] = codeKeyToString(code); });
+        return result;
+    }
+
+    // 单个字节的打包码字，供位流打包直接使用；不在码表中时返回 false
+    bool getByteCode(BYTE b, uint64_t& code) const {
+        const uint64_t* found = byteToCode.find(b);
+        if (!found) return false;
+        code = *found;
+        return true;
     }
 
     wstring decodeText(const wstring& code) const {
         if (codeToChar.empty()) return L"";
         
         wstring result = L"";
-        wstring currentCode;
+        uint64_t bits = 0;
+        unsigned len = 0;
         for (wchar_t bit : code) {
-            currentCode += bit;
-            auto it = codeToChar.find(currentCode);
-            if (it != codeToChar.end()) {
-                result += it->second;
-                currentCode.clear();
+            if (bit != L'0' && bit != L'1') return L"解码错误：存在无效编码";
+            bits = bits << 1 | (uint64_t)(bit == L'1');
+            if (++len > kMaxPackedCodeLen) return L"解码错误：存在无效编码";
+            if (const wchar_t* ch = codeToChar.find(packCodeKey(bits, len))) {
+                result += *ch;
+                bits = 0;
+                len = 0;
             }
         }
-        if (!currentCode.empty()) {
+        if (len != 0) {
             return L"解码错误：存在无效编码";
         }
         return result;
@@ -207,16 +226,19 @@ public:
         if (codeToByte.empty()) return {};
         
         vector<BYTE> result;
-        wstring currentCode;
+        uint64_t bits = 0;
+        unsigned len = 0;
         for (wchar_t bit : code) {
-            currentCode += bit;
-            auto it = codeToByte.find(currentCode);
-            if (it != codeToByte.end()) {
-                result.push_back(it->second);
-                currentCode.clear();
+            if (bit != L'0' && bit != L'1') return {};
+            bits = bits << 1 | (uint64_t)(bit == L'1');
+            if (++len > kMaxPackedCodeLen) return {};
+            if (const BYTE* b = codeToByte.find(packCodeKey(bits, len))) {
+                result.push_back(*b);
+                bits = 0;
+                len = 0;
             }
         }
-        if (!currentCode.empty()) {
+        if (len != 0) {
             return {};  // 解码失败
         }
         return result;
@@ -227,14 +249,13 @@ public:
         wstringstream ss;
         ss << (isImageTree ? L"IMAGE" : L"TEXT") << L"|";  // 标记类型
         
+        auto write = [&ss](uint64_t sym, uint64_t code) {
+            ss << (int)sym << L"|" << codeKeyToString(code) << L"|";
+        };
         if (isImageTree) {
-            for (const auto& p : byteToCode) {
-                ss << (int)p.first << L"|" << p.second << L"|";
-            }
+            byteToCode.forEach(write);
         } else {
-            for (const auto& p : charToCode) {
-                ss << (int)p.first << L"|" << p.second << L"|";
-            }
+            charToCode.forEach(write);
         }
         return ss.str();
     }
@@ -242,9 +263,9 @@ public:
     // 兼容 test7withUI: 仅序列化文本编码表（不带类型前缀）
     wstring serializeTextCodes() const {
         wstringstream ss;
-        for (const auto& p : charToCode) {
-            ss << (int)p.first << L"|" << p.second << L"|";
-        }
+        charToCode.forEach([&ss](uint64_t ch, uint64_t code) {
+            ss << (int)ch << L"|" << codeKeyToString(code) << L"|";
+        });
         return ss.str();
     }
 
@@ -263,9 +284,11 @@ public:
                 return false;
             }
             if (!getline(ss, part, L'|')) return false;
+            uint64_t code;
+            if (!codeStringToKey(part, code)) return false;
             wchar_t ch = (wchar_t)charCode;
-            charToCode[ch] = part;
-            codeToChar[part] = ch;
+            charToCode[ch] = code;
+            codeToChar[code] = ch;
         }
         return !charToCode.empty();
     }
@@ -293,15 +316,17 @@ public:
                 return false;
             }
             if (!getline(ss, part, L'|')) return false;
+            uint64_t code;
+            if (!codeStringToKey(part, code)) return false;
             
             if (isImageTree) {
                 BYTE b = (BYTE)val;
-                byteToCode[b] = part;
-                codeToByte[part] = b;
+                byteToCode[b] = code;
+                codeToByte[code] = b;
             } else {
                 wchar_t ch = (wchar_t)val;
-                charToCode[ch] = part;
-                codeToChar[part] = ch;
+                charToCode[ch] = code;
+                codeToChar[code] = ch;
             }
         }
         return isImageTree ? !byteToCode.empty() : !charToCode.empty();
@@ -327,7 +352,6 @@ public:
             HuffmanNode* newNode = new HuffmanNode(p.first, p.second);
             nodes.push_back(newNode);
             leafnodes.push_back(newNode);
-            byteToCode[p.first] = L"";
         }
 
         while (nodes.size() > 1) {
@@ -360,16 +384,7 @@ public:
         }
 
         for (size_t i = 0; i < leafnodes.size(); ++i) {
-            HuffmanNode* current = leafnodes[i];
-            wstring code = L"";
-            while (current->parent != nullptr) {
-                if (current == current->parent->left) {
-                    code = L"0" + code;
-                } else {
-                    code = L"1" + code;
-                }
-                current = current->parent;
-            }
+            uint64_t code = leafCodeKey(leafnodes[i]);
             byteToCode[leafnodes[i]->byte] = code;
             codeToByte[code] = leafnodes[i]->byte;
         }
@@ -379,46 +394,46 @@ public:
     vector<BYTE> decodeImageFromBits(const uint8_t* bytes, uint64_t bitCount) const {
         if (codeToByte.empty()) return {};
         vector<BYTE> result;
-        wstring currentCode;
+        uint64_t bits = 0;
+        unsigned len = 0;
         for (uint64_t i = 0; i < bitCount; ++i) {
             uint64_t byteIndex = i / 8;
             int bitIndex = 7 - (int)(i % 8);
-            int bit = (bytes[byteIndex] >> bitIndex) & 1;
-            currentCode.push_back(bit ? L'1' : L'0');
-            auto it = codeToByte.find(currentCode);
-            if (it != codeToByte.end()) {
-                result.push_back(it->second);
-                currentCode.clear();
+            bits = bits << 1 | (uint64_t)((bytes[byteIndex] >> bitIndex) & 1);
+            if (++len > kMaxPackedCodeLen) return {};
+            if (const BYTE* b = codeToByte.find(packCodeKey(bits, len))) {
+                result.push_back(*b);
+                bits = 0;
+                len = 0;
             }
         }
-        if (!currentCode.empty()) return {};
+        if (len != 0) return {};
         return result;
     }
 };
 
 wstring encodeText(const wstring& text, const unordered_map<wchar_t, wstring>& codeMap) {
+    // 先把码表转成平坦表，逐字符查找时不再走 unordered_map 的桶链
+    FlatHashMap<const wstring*> lookup;
+    for (const auto& p : codeMap) lookup[(uint64_t)p.first] = &p.second;
     wstring encoded;
     for (wchar_t c : text) {
-        auto it = codeMap.find(c);
-        if (it != codeMap.end()) {
-            encoded += it->second;
-        } else {
-            return L"";
-        }
+        const wstring* const* code = lookup.find((uint64_t)c);
+        if (!code) return L"";
+        encoded += **code;
     }
     return encoded;
 }
 
 // 新增：编码图片字节数据
 wstring encodeImage(const vector<BYTE>& data, const unordered_map<BYTE, wstring>& codeMap) {
+    // 字节只有 256 种，直接用下标表
+    const wstring* lookup[256] = {};
+    for (const auto& p : codeMap) lookup[p.first] = &p.second;
     wstring encoded;
     for (BYTE b : data) {
-        auto it = codeMap.find(b);
-        if (it != codeMap.end()) {
-            encoded += it->second;
-        } else {
-            return L"";
-        }
+        if (!lookup[b]) return L"";
+        encoded += *lookup[b];
     }
     return encoded;
 }
@@ -440,6 +455,14 @@ std::atomic<bool> g_hasImageBinary(false);
 std::atomic<bool> g_imageProcessing(false);
 std::mutex g_imageMutex;
 int g_imgWidth = 0, g_imgHeight = 0, g_imgBpp = 0;
+int g_imgFilter = 0;  // 0: 原始像素；1: 逐行预测滤波后的残差（见 ImageFilter.h）
+// 分通道编码时每个通道平面各自的码表与位流；为空表示整体一张表（g_imageBits / g_codeTableW）
+struct EncodedPlane {
+    std::vector<uint8_t> bits;
+    uint64_t bitCount = 0;
+    std::wstring table;
+};
+std::vector<EncodedPlane> g_imagePlanes;
 uint64_t g_imageBitCount = 0;
 HWND g_mainHwnd = NULL;
 
@@ -656,6 +679,15 @@ void CreateControls(HWND hWnd) {
     CreateWindow(L"BUTTON", L"生成图片编码", WS_VISIBLE | WS_CHILD | BS_PUSHBUTTON,
         0, 0, 1, 1, hWnd, (HMENU)6, hInst, NULL);
 
+    // 预测滤波开关：先做左/上/Paeth 逐行预测再编码残差，照片类图片压缩率明显提高
+    CreateWindow(L"BUTTON", L"预测滤波", WS_VISIBLE | WS_CHILD | BS_AUTOCHECKBOX,
+        0, 0, 1, 1, hWnd, (HMENU)9, hInst, NULL);
+    CheckDlgButton(hWnd, 9, BST_CHECKED);
+
+    // 分通道编码：B/G/R(/A) 各用一张哈夫曼表，多核并行编解码
+    CreateWindow(L"BUTTON", L"分通道编码", WS_VISIBLE | WS_CHILD | BS_AUTOCHECKBOX,
+        0, 0, 1, 1, hWnd, (HMENU)10, hInst, NULL);
+
     // 图片编码/解码文件路径（右侧）
     hLblImageFilePathLabel = CreateWindow(L"STATIC", L"编码文件路径（图片）:", WS_VISIBLE | WS_CHILD,
         0, 0, 1, 1, hWnd, NULL, hInst, NULL);
@@ -774,6 +806,8 @@ void UpdateLayout(HWND hWnd) {
     // 生成/解码按钮一行
     if (GetDlgItem(hWnd, 6)) MoveWindow(GetDlgItem(hWnd, 6), rightX, rtop, 140, btnH, TRUE);
     if (GetDlgItem(hWnd, 7)) MoveWindow(GetDlgItem(hWnd, 7), rightX + 150, rtop, 120, btnH, TRUE);
+    if (GetDlgItem(hWnd, 9)) MoveWindow(GetDlgItem(hWnd, 9), rightX + 280, rtop, 100, btnH, TRUE);
+    if (GetDlgItem(hWnd, 10)) MoveWindow(GetDlgItem(hWnd, 10), rightX + 385, rtop, 110, btnH, TRUE);
     rtop += btnH + 10;
 
     if (hLblImageFilePathLabel) MoveWindow(hLblImageFilePathLabel, rightX, rtop, colW, labelH, TRUE);
@@ -819,6 +853,48 @@ void OnGenerateText(HWND hWnd) {
 }
 
 // 新增：生成图片编码
+// 对一段字节独立建树并打包为 MSB 优先位流；码表中缺少符号时返回 false
+static bool EncodeByteStream(const vector<BYTE>& source, EncodedPlane& plane) {
+    auto sortedFreq = getByteFrequencySorted(source);
+    HuffmanTree localTree;
+    localTree.buildForImage(sortedFreq);
+
+    std::vector<uint8_t> localBits;
+    localBits.reserve(source.size() / 8 + 16);
+    uint8_t curByte = 0;
+    int bitPos = 7;
+    uint64_t totalBits = 0;
+
+    // 码字按字节预取到下标表，打包时直接按位写出
+    uint64_t codes[256];
+    bool present[256] = {};
+    for (const auto& p : sortedFreq) present[p.first] = localTree.getByteCode(p.first, codes[p.first]);
+
+    for (BYTE b : source) {
+        if (!present[b]) return false;
+        unsigned len = packedCodeLen(codes[b]);
+        uint64_t bits = packedCodeBits(codes[b]);
+        for (unsigned i = len; i-- > 0;) {
+            if (bits >> i & 1) curByte |= (1 << bitPos);
+            --bitPos;
+            ++totalBits;
+            if (bitPos < 0) {
+                localBits.push_back(curByte);
+                curByte = 0;
+                bitPos = 7;
+            }
+        }
+    }
+    if (bitPos != 7) {
+        localBits.push_back(curByte);
+    }
+
+    plane.bits.swap(localBits);
+    plane.bitCount = totalBits;
+    plane.table = localTree.serializeCodes();
+    return true;
+}
+
 void OnGenerateImage(HWND hWnd) {
     wchar_t filePath[MAX_PATH];
     GetWindowText(hWndImagePath, filePath, MAX_PATH);
@@ -842,62 +918,67 @@ void OnGenerateImage(HWND hWnd) {
         return;
     }
 
+    // 逐字节像素（8/16/24/32 位）才做预测滤波，低位深调色板图仍按原始字节编码
+    bool byteAligned = bitsPerPixel >= 8 && bitsPerPixel % 8 == 0;
+    bool predict = IsDlgButtonChecked(hWnd, 9) == BST_CHECKED && byteAligned;
+    // 多通道图片才有分平面的意义
+    bool planar = IsDlgButtonChecked(hWnd, 10) == BST_CHECKED && byteAligned && bitsPerPixel >= 16;
+
     g_imageProcessing = true;
     SetWindowText(hWndEncoded, L"图片编码已开始（后台处理），请稍候...");
 
     // 后台线程执行哈夫曼构造与位打包，完成后通过消息通知主线程
-    std::thread worker([imageData, width, height, bitsPerPixel]() {
-        auto sortedFreq = getByteFrequencySorted(imageData);
-        HuffmanTree localTree;
-        localTree.buildForImage(sortedFreq);
-        auto codeMap = localTree.getByteCodeMap();
-
-        std::vector<uint8_t> localBits;
-        localBits.reserve(imageData.size() / 8 + 16);
-        uint8_t curByte = 0;
-        int bitPos = 7;
-        uint64_t totalBits = 0;
-
-        for (BYTE b : imageData) {
-            auto it = codeMap.find(b);
-            if (it == codeMap.end()) {
-                // error
-                std::lock_guard<std::mutex> lk(g_imageMutex);
-                g_hasImageBinary = false;
-                g_imageProcessing = false;
-                if (g_mainHwnd) PostMessage(g_mainHwnd, WM_ENCODE_DONE, 0, 0);
-                return;
+    std::thread worker([imageData, width, height, bitsPerPixel, predict, planar]() {
+        const int bytesPerPixel = bitsPerPixel / 8;
+        bool ok = true;
+        EncodedPlane single;
+        std::vector<EncodedPlane> planes;
+
+        if (planar) {
+            // 交错的 BGR(A) 拆成各通道平面，每个平面单独滤波、建树、打包，平面之间并行
+            planes.resize(bytesPerPixel);
+            std::vector<char> planeOk(bytesPerPixel, 0);
+            std::vector<std::thread> planeWorkers;
+            for (int c = 0; c < bytesPerPixel; ++c) {
+                planeWorkers.emplace_back([&imageData, &planes, &planeOk, c, width, height, bytesPerPixel, predict]() {
+                    const size_t count = (size_t)width * height;
+                    std::vector<BYTE> plane(count);
+                    for (size_t i = 0; i < count; ++i) plane[i] = imageData[i * bytesPerPixel + c];
+                    if (predict) {
+                        std::vector<BYTE> filtered(filteredImageSize(width, height, 1));
+                        filterImageRows(plane.data(), width, height, 1, filtered.data());
+                        plane.swap(filtered);
+                    }
+                    planeOk[c] = EncodeByteStream(plane, planes[c]) ? 1 : 0;
+                });
             }
-            const wstring& code = it->second;
-            for (wchar_t wc : code) {
-                int bit = (wc == L'1') ? 1 : 0;
-                if (bit) curByte |= (1 << bitPos);
-                --bitPos;
-                ++totalBits;
-                if (bitPos < 0) {
-                    localBits.push_back(curByte);
-                    curByte = 0;
-                    bitPos = 7;
-                }
+            for (auto& t : planeWorkers) t.join();
+            for (char r : planeOk) ok = ok && r;
+        } else {
+            std::vector<BYTE> filtered;
+            if (predict) {
+                filtered.resize(filteredImageSize(width, height, bytesPerPixel));
+                filterImageRows(imageData.data(), width, height, bytesPerPixel, filtered.data());
             }
+            ok = EncodeByteStream(predict ? filtered : imageData, single);
         }
-        if (bitPos != 7) {
-            localBits.push_back(curByte);
-        }
-
-        // serialize code table
-        wstring codeTable = localTree.serializeCodes();
 
         // store into globals
         {
             std::lock_guard<std::mutex> lk(g_imageMutex);
-            g_imageBits.swap(localBits);
-            g_codeTableW = codeTable;
-            g_hasImageBinary = true;
-            g_imageBitCount = totalBits;
-            g_imgWidth = width;
-            g_imgHeight = height;
-            g_imgBpp = bitsPerPixel;
+            if (!ok) {
+                g_hasImageBinary = false;
+            } else {
+                g_imageBits.swap(single.bits);
+                g_codeTableW = single.table;
+                g_imageBitCount = single.bitCount;
+                g_imagePlanes.swap(planes);
+                g_hasImageBinary = true;
+                g_imgWidth = width;
+                g_imgHeight = height;
+                g_imgBpp = bitsPerPixel;
+                g_imgFilter = predict ? 1 : 0;
+            }
         }
 
         if (g_mainHwnd) PostMessage(g_mainHwnd, WM_ENCODE_DONE, 0, 0);
@@ -921,7 +1002,9 @@ void OnSave(HWND hWnd) {
     wstring path = SaveFileDialog(hWnd);
     if (path.empty()) return;
 
-    // 如果存在图片二进制缓存，写入二进制格式：CODE_TABLE_START\n<utf8 table>\nCODE_DATA_START\nBIN_IMAGE|w|h|bpp|bitcount\n<raw bytes>
+    // 如果存在图片二进制缓存，写入二进制格式：CODE_TABLE_START\n<utf8 table>\nCODE_DATA_START\nBIN_IMAGE|w|h|bpp|bitcount[|filter]\n<raw bytes>
+    // filter 字段仅在启用预测滤波时写出，旧文件没有该字段
+    // 分通道编码时：码表区每行一张平面码表，数据头为 BIN_PLANES|w|h|bpp|filter|n|bitcount0|...，随后各平面位流依次紧接
     if (g_hasImageBinary) {
         // convert path to UTF-8
         int need = WideCharToMultiByte(CP_UTF8, 0, path.c_str(), -1, NULL, 0, NULL, NULL);
@@ -936,13 +1019,33 @@ void OnSave(HWND hWnd) {
 
         std::wstring codeTableW;
         std::vector<uint8_t> bitsCopy;
-        int w=0,h=0,bpp=0;
+        std::vector<EncodedPlane> planesCopy;
+        int w=0,h=0,bpp=0,filter=0;
         uint64_t bitCount=0;
         {
             std::lock_guard<std::mutex> lk(g_imageMutex);
             codeTableW = g_codeTableW;
             bitsCopy = g_imageBits;
-            w = g_imgWidth; h = g_imgHeight; bpp = g_imgBpp; bitCount = g_imageBitCount;
+            planesCopy = g_imagePlanes;
+            w = g_imgWidth; h = g_imgHeight; bpp = g_imgBpp; bitCount = g_imageBitCount; filter = g_imgFilter;
+        }
+
+        if (!planesCopy.empty()) {
+            fout << "CODE_TABLE_START\n";
+            for (const auto& plane : planesCopy) {
+                // 图片码表只含数字、'|' 与 '0'/'1'，逐字符收窄即为 UTF-8
+                fout << std::string(plane.table.begin(), plane.table.end()) << "\n";
+            }
+            fout << "CODE_DATA_START\n";
+            fout << "BIN_PLANES|" << w << "|" << h << "|" << bpp << "|" << filter << "|" << planesCopy.size();
+            for (const auto& plane : planesCopy) fout << "|" << plane.bitCount;
+            fout << "\n";
+            for (const auto& plane : planesCopy) {
+                fout.write(reinterpret_cast<const char*>(plane.bits.data()), plane.bits.size());
+            }
+            fout.close();
+            MessageBox(hWnd, L"保存成功（已写入分通道二进制位流）", L"提示", MB_OK);
+            return;
         }
 
         // convert codeTable to UTF-8
@@ -956,7 +1059,9 @@ void OnSave(HWND hWnd) {
         fout << "CODE_TABLE_START\n";
         fout << codeTableUtf8 << "\n";
         fout << "CODE_DATA_START\n";
-        fout << "BIN_IMAGE|" << w << "|" << h << "|" << bpp << "|" << bitCount << "\n";
+        fout << "BIN_IMAGE|" << w << "|" << h << "|" << bpp << "|" << bitCount;
+        if (filter) fout << "|" << filter;
+        fout << "\n";
         if (!bitsCopy.empty()) {
             fout.write(reinterpret_cast<const char*>(bitsCopy.data()), bitsCopy.size());
         }
@@ -1035,6 +1140,89 @@ void OnDecodeText(HWND hWnd) {
     }
 }
 
+// 分通道位流解码：解析 BIN_PLANES 数据头与逐行码表，各平面并行解码后重新交错为像素
+static vector<BYTE> DecodeImagePlanes(const std::string& headerLine, const std::string& codeTablesUtf8,
+                                      const std::string& content, size_t binStart,
+                                      int& width, int& height, int& bpp) {
+    int filter = 0;
+    size_t planeCount = 0;
+    std::vector<uint64_t> bitCounts;
+    try {
+        std::stringstream ss(headerLine);
+        std::string token;
+        getline(ss, token, '|'); // BIN_PLANES
+        getline(ss, token, '|'); width = stoi(token);
+        getline(ss, token, '|'); height = stoi(token);
+        getline(ss, token, '|'); bpp = stoi(token);
+        getline(ss, token, '|'); filter = stoi(token);
+        getline(ss, token, '|'); planeCount = stoul(token);
+        for (size_t i = 0; i < planeCount && getline(ss, token, '|'); ++i) bitCounts.push_back(stoull(token));
+    } catch (...) {
+        return {};
+    }
+    const int bytesPerPixel = bpp / 8;
+    if (width <= 0 || height <= 0 || bytesPerPixel <= 0 || planeCount != (size_t)bytesPerPixel ||
+        bitCounts.size() != planeCount || (filter != 0 && filter != 1)) {
+        return {};
+    }
+
+    std::vector<std::wstring> tables;
+    {
+        std::stringstream ts(codeTablesUtf8);
+        std::string line;
+        while (getline(ts, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) tables.emplace_back(line.begin(), line.end());
+        }
+    }
+    if (tables.size() != planeCount) return {};
+
+    // 各平面位流按字节对齐依次存放
+    std::vector<size_t> offsets(planeCount);
+    size_t offset = binStart;
+    for (size_t c = 0; c < planeCount; ++c) {
+        offsets[c] = offset;
+        offset += (size_t)((bitCounts[c] + 7) / 8);
+    }
+    if (offset > content.size()) return {};
+
+    const size_t count = (size_t)width * height;
+    vector<BYTE> pixels(count * bytesPerPixel);
+    std::vector<char> planeOk(planeCount, 0);
+    std::vector<std::thread> workers;
+    for (size_t c = 0; c < planeCount; ++c) {
+        workers.emplace_back([&, c]() {
+            HuffmanTree tree;
+            if (!tree.deserializeCodes(tables[c])) return;
+            vector<BYTE> plane;
+            if (bitCounts[c] == 0) {
+                // 只有一种取值的平面（如全不透明的 Alpha）码字为空、没有位流，直接用码表里唯一的符号填满
+                std::wstringstream ts(tables[c]);
+                std::wstring part;
+                getline(ts, part, L'|'); // IMAGE
+                if (!getline(ts, part, L'|') || part.empty()) return;
+                plane.assign(filter == 1 ? filteredImageSize(width, height, 1) : count, (BYTE)wcstol(part.c_str(), NULL, 10));
+            } else {
+                const uint8_t* bits = reinterpret_cast<const uint8_t*>(content.data() + offsets[c]);
+                plane = tree.decodeImageFromBits(bits, bitCounts[c]);
+            }
+            if (filter == 1) {
+                vector<BYTE> raw(count);
+                if (!unfilterImageRows(plane.data(), plane.size(), width, height, 1, raw.data())) return;
+                plane.swap(raw);
+            }
+            if (plane.size() != count) return;
+            for (size_t i = 0; i < count; ++i) pixels[i * bytesPerPixel + c] = plane[i];
+            planeOk[c] = 1;
+        });
+    }
+    for (auto& t : workers) t.join();
+    for (char r : planeOk) {
+        if (!r) return {};
+    }
+    return pixels;
+}
+
 // 图片解码（处理二进制位流或文本图片编码，保存为 BMP）
 void OnDecodeImage(HWND hWnd) {
     wchar_t filePath[MAX_PATH];
@@ -1095,32 +1283,50 @@ void OnDecodeImage(HWND hWnd) {
         MultiByteToWideChar(CP_UTF8, 0, codeTableUtf8.c_str(), (int)codeTableUtf8.size(), &codeTableW[0], sz);
     }
 
-    if (headerLine.rfind("BIN_IMAGE|", 0) == 0) {
+    bool planarFile = headerLine.rfind("BIN_PLANES|", 0) == 0;
+    if (planarFile || headerLine.rfind("BIN_IMAGE|", 0) == 0) {
         int width=0, height=0, bpp=0;
-        uint64_t bitCount = 0;
-        {
-            std::stringstream ss(headerLine);
-            std::string token;
-            getline(ss, token, '|'); // BIN_IMAGE
-            getline(ss, token, '|'); width = stoi(token);
-            getline(ss, token, '|'); height = stoi(token);
-            getline(ss, token, '|'); bpp = stoi(token);
-            getline(ss, token, '|'); bitCount = stoull(token);
-        }
+        vector<BYTE> imageData;
+        if (planarFile) {
+            imageData = DecodeImagePlanes(headerLine, codeTableUtf8, content, newlinePos + 1, width, height, bpp);
+        } else {
+            int filter = 0;
+            uint64_t bitCount = 0;
+            {
+                std::stringstream ss(headerLine);
+                std::string token;
+                getline(ss, token, '|'); // BIN_IMAGE
+                getline(ss, token, '|'); width = stoi(token);
+                getline(ss, token, '|'); height = stoi(token);
+                getline(ss, token, '|'); bpp = stoi(token);
+                getline(ss, token, '|'); bitCount = stoull(token);
+                if (getline(ss, token, '|') && !token.empty()) filter = stoi(token);
+            }
 
-        size_t binStart = newlinePos + 1;
-        if (binStart > content.size()) {
-            MessageBox(hWnd, L"无效的二进制数据", L"错误", MB_ICONERROR | MB_OK);
-            return;
-        }
-        const unsigned char* binPtr = reinterpret_cast<const unsigned char*>(content.data() + binStart);
+            size_t binStart = newlinePos + 1;
+            if (binStart > content.size()) {
+                MessageBox(hWnd, L"无效的二进制数据", L"错误", MB_ICONERROR | MB_OK);
+                return;
+            }
+            const unsigned char* binPtr = reinterpret_cast<const unsigned char*>(content.data() + binStart);
 
-        if (!currentTree.deserializeCodes(codeTableW)) {
-            MessageBox(hWnd, L"解码失败，编码表无效", L"错误", MB_ICONERROR | MB_OK);
-            return;
-        }
+            if (!currentTree.deserializeCodes(codeTableW)) {
+                MessageBox(hWnd, L"解码失败，编码表无效", L"错误", MB_ICONERROR | MB_OK);
+                return;
+            }
 
-        vector<BYTE> imageData = currentTree.decodeImageFromBits(binPtr, bitCount);
+            imageData = currentTree.decodeImageFromBits(binPtr, bitCount);
+            if (!imageData.empty() && filter == 1) {
+                // 解出的是逐行预测残差，还原为像素
+                vector<BYTE> pixels((size_t)width * height * (bpp / 8));
+                if (!unfilterImageRows(imageData.data(), imageData.size(), width, height, bpp / 8, pixels.data())) {
+                    pixels.clear();
+                }
+                imageData.swap(pixels);
+            } else if (filter != 0) {
+                imageData.clear();
+            }
+        }
         if (imageData.empty()) {
             MessageBox(hWnd, L"图片解码失败", L"错误", MB_ICONERROR | MB_OK);
             return;
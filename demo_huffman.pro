@@ -3,10 +3,18 @@ CONFIG += c++11
 
 SOURCES += huffman_main.cpp \
            huffmantree.cpp \
-           huffmanwidget.cpp
+           huffmanwidget.cpp \
+           src/frontend/src/huffmanlayout.cpp \
+           src/frontend/src/huffmangraphics.cpp \
+           src/frontend/src/huffmananimator.cpp
 
 HEADERS += huffmantree.h \
-           huffmanwidget.h
+           huffmanwidget.h \
+           src/frontend/include/huffmanlayout.h \
+           src/frontend/include/huffmangraphics.h \
+           src/frontend/include/huffmananimator.h
+
+INCLUDEPATH += src/frontend/include
 
 TARGET = HuffmanDemo
 TEMPLATE = app
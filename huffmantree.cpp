@@ -12,32 +12,44 @@ QVector<HuffStep> HuffmanBuilder::buildSteps()
     // create initial nodes
     QVector<QSharedPointer<HuffNode>> pool;
     int nextId = 0;
+    pool.reserve(m_items.size());
     for (const auto &p : m_items) {
-        auto node = QSharedPointer<HuffNode>::create(p.second, p.first, nextId++);
-        pool.append(node);
+        pool.append(QSharedPointer<HuffNode>::create(p.second, p.first, nextId++));
     }
 
-    // use simple greedy algorithm
-    while (pool.size() > 1) {
-        // sort ascending by weight, tie-break by id
-        std::sort(pool.begin(), pool.end(), [](const QSharedPointer<HuffNode>& n1, const QSharedPointer<HuffNode>& n2){
-            if (n1->weight != n2->weight) return n1->weight < n2->weight;
-            return n1->id < n2->id;
-        });
+    // two-queue Huffman: sort the leaves once by (weight, id); merged nodes are
+    // created with non-decreasing weight and increasing id, so appending them to
+    // a FIFO keeps it sorted too. Taking the smaller front each time yields the
+    // same sequence as re-sorting the whole pool per merge, in O(n log n) total.
+    auto less = [](const QSharedPointer<HuffNode>& n1, const QSharedPointer<HuffNode>& n2){
+        if (n1->weight != n2->weight) return n1->weight < n2->weight;
+        return n1->id < n2->id;
+    };
+    std::sort(pool.begin(), pool.end(), less);
 
-        auto a = pool.takeFirst();
-        auto b = pool.takeFirst();
-        auto parent = QSharedPointer<HuffNode>::create(a->weight + b->weight, QString(), nextId++);
-        parent->left = a;
-        parent->right = b;
+    const int mergeCount = pool.size() - 1;
+    QVector<QSharedPointer<HuffNode>> merged;
+    merged.reserve(qMax(mergeCount, 0));
+    steps.reserve(qMax(mergeCount, 0));
+    int leafHead = 0;
+    int mergedHead = 0;
+    auto takeSmallest = [&]() -> QSharedPointer<HuffNode>& {
+        if (mergedHead >= merged.size()
+            || (leafHead < pool.size() && less(pool[leafHead], merged[mergedHead]))) {
+            return pool[leafHead++];
+        }
+        return merged[mergedHead++];
+    };
 
+    for (int i = 0; i < mergeCount; ++i) {
         HuffStep s;
-        s.a = a;
-        s.b = b;
-        s.parent = parent;
-        steps.append(s);
-
-        pool.append(parent);
+        s.a = takeSmallest();
+        s.b = takeSmallest();
+        s.parent = QSharedPointer<HuffNode>::create(s.a->weight + s.b->weight, QString(), nextId++);
+        s.parent->left = s.a;
+        s.parent->right = s.b;
+        merged.append(s.parent);
+        steps.append(std::move(s));
     }
 
     return steps;
@@ -7,8 +7,10 @@
 #include <QPushButton>
 #include <QTimer>
 #include <QSlider>
-#include <QAbstractAnimation>
 #include "huffmantree.h"
+#include "huffmanlayout.h"
+#include "huffmangraphics.h"
+#include "huffmananimator.h"
 
 class HuffmanWidget : public QMainWindow
 {
@@ -31,6 +33,7 @@ private:
     void drawEdges(int stepsDone);
     void onZoomChanged(int value);
 
+    void rebuildSteps();
     void prepareInitialNodes();
     void performStep(const HuffStep &step);
 
@@ -45,10 +48,12 @@ private:
     QVector<QPair<QString,int>> m_items;
     QVector<HuffStep> m_steps;
     int m_currentStep{0};
-    // mapping node id -> QGraphicsItem group
-    QMap<int, QGraphicsItem*> m_itemMap;
-    QVector<QGraphicsItem*> m_edgeItems;
-    QVector<QAbstractAnimation*> m_activeAnims;
+    HuffmanLayout m_layout;
+    QVector<QPointF> m_positions;
+    // node id -> graphics item (parents are appended as steps are performed)
+    QVector<HuffmanNodeItem*> m_nodeItems;
+    HuffmanEdgeItem *m_edgeItem{nullptr};
+    HuffmanAnimator m_animator;
 };
 
 #endif // HUFFMANWIDGET_H
@@ -7,6 +7,12 @@ except Exception as e:
     sys.stderr.write('jieba import error: ' + str(e))
     sys.exit(2)
 
+# --dict-path: print the dictionary file bundled with jieba (loaded by the native segmenter)
+if len(sys.argv) > 1 and sys.argv[1] == '--dict-path':
+    import os
+    sys.stdout.write(os.path.join(os.path.dirname(jieba.__file__), 'dict.txt'))
+    sys.exit(0)
+
 data = sys.stdin.read()
 if not data:
     sys.exit(0)
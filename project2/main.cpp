@@ -26,13 +26,543 @@
 #include <QSortFilterProxyModel>
 #include <QTextStream>
 #include <QSlider>
+#include <QCheckBox>
+#include <QSpinBox>
 #include <unordered_map>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
 
 // 使用 Qt Charts 的类在全局命名空间可直接使用 QChart 等类型
 
-using StringFreqMap = std::unordered_map<std::string, size_t>;
+// Token interner: UTF-8 bytes of every distinct token live once in an append-only arena,
+// and an open-addressing table (linear probing) maps them to dense ids. Slots carry
+// (offset, len, hash, id), so a lookup by string_view is one hash plus one probe run
+// that compares inline fields before touching the arena; nothing is allocated per token
+// once the arena and table have grown to the working set.
+class TokenInterner {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    static uint64_t hashOf(std::string_view s) { return std::hash<std::string_view>()(s); }
+
+    uint32_t find(std::string_view s, uint64_t h) const {
+        if (slots.empty()) return npos;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            const Slot &slot = slots[i];
+            if (slot.id == npos) return npos;
+            if (slot.hash == (uint32_t)h && slot.len == s.size() &&
+                std::memcmp(arena.data() + slot.offset, s.data(), s.size()) == 0) return slot.id;
+        }
+    }
+
+    // s must not be present yet; reuses the most recently erased id first
+    uint32_t insert(std::string_view s, uint64_t h) {
+        if ((liveCount + 1) * 4 > slots.size() * 3) rehash(std::max<size_t>(64, slots.size() * 2));
+        uint32_t id;
+        if (!freeIds.empty()) { id = freeIds.back(); freeIds.pop_back(); }
+        else { id = (uint32_t)tokens.size(); tokens.emplace_back(); }
+        Slot slot{arena.size(), (uint32_t)s.size(), (uint32_t)h, id};
+        arena.insert(arena.end(), s.begin(), s.end());
+        tokens[id] = slot;
+        place(slot);
+        ++liveCount;
+        return id;
+    }
+
+    // drops id from the table (backward-shift deletion keeps probe runs intact);
+    // the arena is compacted once more than half of it belongs to erased tokens
+    void erase(uint32_t id) {
+        Slot &tok = tokens[id];
+        size_t i = tok.hash & mask;
+        while (slots[i].id != id) i = (i + 1) & mask;
+        for (size_t j = (i + 1) & mask; slots[j].id != npos; j = (j + 1) & mask) {
+            size_t home = slots[j].hash & mask;
+            // move slots[j] into the hole unless its home lies cyclically in (i, j]
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i].id = npos;
+        tok.id = npos;
+        deadBytes += tok.len;
+        freeIds.push_back(id);
+        --liveCount;
+        if (deadBytes > 64 * 1024 && deadBytes * 2 > arena.size()) compact();
+    }
+
+    std::string_view view(uint32_t id) const { return std::string_view(arena.data() + tokens[id].offset, tokens[id].len); }
+    size_t size() const { return liveCount; }
+
+private:
+    struct Slot {
+        uint64_t offset; // 64-bit: the arena may outgrow 4 GiB in exact mode
+        uint32_t len;
+        uint32_t hash; // low 32 bits of the full hash; also the home position
+        uint32_t id;
+    };
+
+    void place(const Slot &slot) {
+        size_t i = slot.hash & mask;
+        while (slots[i].id != npos) i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+
+    void rehash(size_t capacity) {
+        slots.assign(capacity, Slot{0, 0, 0, npos});
+        mask = capacity - 1;
+        for (const Slot &tok : tokens) {
+            if (tok.id != npos) place(tok);
+        }
+    }
+
+    void compact() {
+        std::vector<char> packed;
+        packed.reserve(arena.size() - deadBytes);
+        for (Slot &tok : tokens) {
+            if (tok.id == npos) continue;
+            uint64_t offset = packed.size();
+            packed.insert(packed.end(), arena.begin() + tok.offset, arena.begin() + tok.offset + tok.len);
+            tok.offset = offset;
+        }
+        arena.swap(packed);
+        deadBytes = 0;
+        rehash(slots.size());
+    }
+
+    std::vector<char> arena;
+    std::vector<Slot> slots;
+    std::vector<Slot> tokens; // by id; id == npos marks an erased token
+    std::vector<uint32_t> freeIds;
+    size_t mask = 0;
+    size_t liveCount = 0;
+    size_t deadBytes = 0;
+};
+
+// Incremental top-K counter (bucketed frequency list, as in Stream-Summary).
+// Buckets hold all keys with the same count and form a list ordered by count;
+// an increment moves one key to the neighbouring bucket in O(1), so the current
+// top entries are read by walking down from the highest bucket, with no sorting.
+//
+// With a capacity m > 0 it becomes the Space-Saving heavy-hitter sketch: at most m keys
+// are kept, and an unseen key takes over an entry of the lowest bucket, inheriting its
+// count. Memory is then fixed, and after N increments every reported count is an upper
+// bound that overestimates by at most maxError() <= N / m; any key occurring more than
+// N / m times is guaranteed to be present.
+class TopKCounter {
+public:
+    explicit TopKCounter(size_t capacity = 0) : capacity(capacity) {}
+
+    // entries share ids with the interner, so a hit costs one probe and no allocation
+    void increment(std::string_view key) {
+        ++total;
+        const uint64_t h = TokenInterner::hashOf(key);
+        uint32_t e = tokens.find(key, h);
+        if (e == npos && capacity > 0 && tokens.size() >= capacity) {
+            // Space-Saving: evict one key with the minimum count; its id is reused for the new key
+            const uint32_t victim = buckets[lowest].first;
+            tokens.erase(victim);
+            evicted = true;
+            e = tokens.insert(key, h);
+        } else if (e == npos) {
+            e = tokens.insert(key, h);
+            if (e >= entries.size()) entries.resize(e + 1);
+            uint32_t b = (lowest != npos && buckets[lowest].count == 1) ? lowest : newBucket(1, npos, lowest);
+            link(e, b);
+            return;
+        }
+        const uint32_t b = entries[e].bucket;
+        const size_t count = buckets[b].count + 1;
+        const uint32_t up = buckets[b].higher;
+        uint32_t target = (up != npos && buckets[up].count == count) ? up : newBucket(count, b, up);
+        unlink(e);
+        link(e, target);
+    }
+
+    size_t size() const { return tokens.size(); }
+    uint64_t totalCount() const { return total; }
+    bool approximate() const { return capacity > 0; }
+    // largest possible overestimate of any reported count (0 while nothing was evicted)
+    size_t maxError() const { return evicted ? buckets[lowest].count : 0; }
+
+    // calls f(key, count) for at most k entries, highest count first
+    template <typename F>
+    void forEachTop(size_t k, F &&f) const {
+        for (uint32_t b = highest; b != npos && k > 0; b = buckets[b].lower) {
+            for (uint32_t e = buckets[b].first; e != npos && k > 0; e = entries[e].next, --k) {
+                f(tokens.view(e), buckets[b].count);
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t npos = UINT32_MAX;
+    struct Entry {
+        uint32_t bucket, prev, next;
+    };
+    struct Bucket {
+        size_t count;
+        uint32_t first;
+        uint32_t lower, higher;
+    };
+
+    uint32_t newBucket(size_t count, uint32_t lower, uint32_t higher) {
+        uint32_t b;
+        if (!freeBuckets.empty()) { b = freeBuckets.back(); freeBuckets.pop_back(); }
+        else { b = (uint32_t)buckets.size(); buckets.emplace_back(); }
+        buckets[b] = Bucket{count, npos, lower, higher};
+        if (lower != npos) buckets[lower].higher = b; else lowest = b;
+        if (higher != npos) buckets[higher].lower = b; else highest = b;
+        return b;
+    }
+
+    void link(uint32_t e, uint32_t b) {
+        Entry &en = entries[e];
+        en.bucket = b;
+        en.prev = npos;
+        en.next = buckets[b].first;
+        if (en.next != npos) entries[en.next].prev = e;
+        buckets[b].first = e;
+    }
+
+    // detaches e from its bucket and drops the bucket once it is empty
+    void unlink(uint32_t e) {
+        Entry &en = entries[e];
+        Bucket &bk = buckets[en.bucket];
+        if (en.prev != npos) entries[en.prev].next = en.next; else bk.first = en.next;
+        if (en.next != npos) entries[en.next].prev = en.prev;
+        if (bk.first != npos) return;
+        if (bk.lower != npos) buckets[bk.lower].higher = bk.higher; else lowest = bk.higher;
+        if (bk.higher != npos) buckets[bk.higher].lower = bk.lower; else highest = bk.lower;
+        freeBuckets.push_back(en.bucket);
+    }
+
+    TokenInterner tokens;
+    std::vector<Entry> entries; // by token id
+    std::vector<Bucket> buckets;
+    std::vector<uint32_t> freeBuckets;
+    uint32_t lowest = npos;
+    uint32_t highest = npos;
+    size_t capacity;
+    uint64_t total = 0;
+    bool evicted = false; // counts stay exact until the first eviction
+};
+
+// whitespace and punctuation never become single-character tokens
+static bool isSkippedChar(QChar c) {
+    if (c.isSpace()) return true;
+    QChar::Category cat = c.category();
+    return (cat == QChar::Punctuation_Connector || cat == QChar::Punctuation_Dash ||
+            cat == QChar::Punctuation_Open || cat == QChar::Punctuation_Close ||
+            cat == QChar::Punctuation_InitialQuote || cat == QChar::Punctuation_FinalQuote ||
+            cat == QChar::Punctuation_Other);
+}
+
+// code point at text[i] (surrogate pairs combined); step receives its UTF-16 length
+static char32_t codePointAt(const QChar *text, int n, int i, int &step) {
+    char16_t c = text[i].unicode();
+    if (QChar::isHighSurrogate(c) && i + 1 < n && text[i + 1].isLowSurrogate()) {
+        step = 2;
+        return QChar::surrogateToUcs4(c, text[i + 1].unicode());
+    }
+    step = 1;
+    return c;
+}
+
+static bool isHanChar(char32_t c) { return QChar::script(c) == QChar::Script_Han; }
+
+// what \w matched in the old QRegularExpression (no UseUnicodePropertiesOption): ASCII only
+static bool isWordChar(char32_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Dictionary-based forward maximum matching segmenter, loaded once per process.
+// Words live in a character trie; edges are keyed by (parent node, UTF-16 unit)
+// so CJK fan-out costs no per-node tables. Characters not starting a dictionary
+// word (all of them when no dictionary was found) become single-character pieces.
+class ChineseSegmenter {
+public:
+    // jieba dictionary format: one "word [freq [tag]]" per line, UTF-8
+    bool load(const QString &path) {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+        while (!f.atEnd()) {
+            QString line = QString::fromUtf8(f.readLine()).trimmed();
+            int sp = line.indexOf(' ');
+            insert(sp < 0 ? line : line.left(sp));
+        }
+        return wordCount > 0;
+    }
+
+    void insert(const QString &word) {
+        if (word.size() < 2) return; // single characters are the fallback anyway
+        uint32_t node = 0;
+        for (QChar c : word) {
+            uint64_t key = (uint64_t)node << 16 | c.unicode();
+            auto it = edges.find(key);
+            if (it == edges.end()) {
+                it = edges.emplace(key, (uint32_t)terminal.size()).first;
+                terminal.push_back(0);
+            }
+            node = it->second;
+        }
+        if (!terminal[node]) { terminal[node] = 1; ++wordCount; }
+        maxWordLen = std::max(maxWordLen, (int)word.size());
+    }
+
+    // appends (start, length) pieces of text[0, n); characters not covered by a dictionary
+    // word become single pieces (a whole code point, so surrogate pairs stay together),
+    // except whitespace and punctuation, which are dropped
+    void segmentSpans(const QChar *text, int n, std::vector<std::pair<int, int>> &out) const {
+        for (int i = 0; i < n;) {
+            // longest dictionary word starting at i, else the code point at i
+            int best = 1;
+            codePointAt(text, n, i, best);
+            uint32_t node = 0;
+            for (int k = i; k < n && k - i < maxWordLen; ++k) {
+                auto it = edges.find((uint64_t)node << 16 | text[k].unicode());
+                if (it == edges.end()) break;
+                node = it->second;
+                if (terminal[node] && k - i + 1 > best) best = k - i + 1;
+            }
+            if (best > 1 || !isSkippedChar(text[i])) out.emplace_back(i, best);
+            i += best;
+        }
+    }
+
+private:
+    std::unordered_map<uint64_t, uint32_t> edges;
+    std::vector<uint8_t> terminal{0}; // node 0 is the root
+    size_t wordCount = 0;
+    int maxWordLen = 0;
+};
+
+// Looks for dict.txt next to the executable first; otherwise asks python once for the
+// dictionary shipped with jieba (via jieba_segment.py --dict-path).
+static const ChineseSegmenter &sharedSegmenter() {
+    static const ChineseSegmenter segmenter = []() {
+        ChineseSegmenter seg;
+        QString dir = QCoreApplication::applicationDirPath() + QDir::separator();
+        if (seg.load(dir + "dict.txt")) return seg;
+        QString helper = dir + "jieba_segment.py";
+        if (QFile::exists(helper)) {
+            QProcess p;
+            p.start("python", QStringList() << helper << "--dict-path"); // assume python in PATH
+            if (p.waitForFinished(5000) && p.exitCode() == 0) {
+                seg.load(QString::fromUtf8(p.readAllStandardOutput()).trimmed());
+            }
+        }
+        return seg;
+    }();
+    return segmenter;
+}
+
+// Immutable result of one publish: the top entries by count plus progress info.
+// The UI only reads these; all counting happens on the engine's worker thread.
+struct FreqSnapshot {
+    std::vector<std::pair<std::string, size_t>> top; // sorted by count, descending
+    size_t distinct = 0;
+    uint64_t totalTokens = 0;
+    bool approximate = false;
+    size_t maxError = 0; // approximate mode: counts may be too high by at most this much
+    qint64 bytesRead = 0;
+    qint64 fileSize = 0;
+    QString preview;
+    bool finished = false;
+};
+
+// Single-producer / single-consumer snapshot exchange without locks.
+// Three slots: the writer fills its back slot and swaps it into the middle,
+// the reader swaps the middle out when it carries the fresh bit. Neither side
+// ever touches the slot the other one owns, so no copy happens under contention.
+template <typename T>
+class SnapshotBuffer {
+public:
+    T &back() { return slots[backIdx]; }
+    void publish() { backIdx = middle.exchange(backIdx | kFresh, std::memory_order_acq_rel) & kIndexMask; }
+    // returns nullptr when nothing was published since the last call
+    const T *acquire() {
+        if (!(middle.load(std::memory_order_acquire) & kFresh)) return nullptr;
+        frontIdx = middle.exchange(frontIdx, std::memory_order_acq_rel) & kIndexMask;
+        return &slots[frontIdx];
+    }
+
+private:
+    static constexpr uint8_t kFresh = 4;
+    static constexpr uint8_t kIndexMask = 3;
+    T slots[3];
+    std::atomic<uint8_t> middle{1};
+    uint8_t backIdx = 0;  // writer only
+    uint8_t frontIdx = 2; // reader only
+};
+
+// Background counting engine: reads the file at disk speed on a worker thread,
+// tokenizes/segments/counts into its own map and publishes a FreqSnapshot every
+// publishIntervalMs. Destroying the engine stops and joins the worker.
+// capacity > 0 selects the fixed-memory approximate mode (see TopKCounter).
+class FreqCountEngine {
+public:
+    explicit FreqCountEngine(size_t capacity = 0) : counts(capacity) {}
+
+    static constexpr int publishIntervalMs = 100;
+    static constexpr int snapshotTopN = 200;
+    static constexpr int readChars = 64 * 1024;
+    static constexpr int previewMaxChars = 20000;
+
+    ~FreqCountEngine() { stop(); }
+
+    bool start(const QString &path) {
+        file.setFileName(path);
+        if (!file.open(QIODevice::ReadOnly)) return false;
+        worker = std::thread([this]() { run(); });
+        return true;
+    }
+    // stops reading and joins the worker; the last published snapshot covers everything counted
+    void stop() {
+        stopRequested = true;
+        if (worker.joinable()) worker.join();
+    }
+    // GUI thread: latest snapshot if a new one was published, else nullptr
+    const FreqSnapshot *poll() { return snapshots.acquire(); }
+
+private:
+    void run() {
+        QTextStream stream(&file);
+        const qint64 fileSize = file.size();
+        QString leftover;
+        QString preview;
+        auto lastPublish = std::chrono::steady_clock::now();
+        while (!stopRequested) {
+            QString chunk = stream.read(readChars);
+            if (chunk.isEmpty()) break;
+            if (preview.size() < previewMaxChars) preview += chunk.left(previewMaxChars - preview.size());
+
+            // process up to the last ASCII punctuation/space boundary, keep the rest for the next chunk
+            leftover.append(chunk);
+            int lastSep = -1;
+            for (int i = leftover.size()-1; i >= 0 && i >= leftover.size()-64; --i) {
+                QChar c = leftover.at(i);
+                if (c.isSpace() || c == ',' || c == '.' || c == ';' || c == ':' || c == '!' || c == '?' || c == '(' || c == ')' || c == '"' || c == '\'') { lastSep = i; break; }
+            }
+            if (lastSep >= 0) {
+                countText(leftover.left(lastSep+1));
+                leftover = leftover.mid(lastSep+1);
+            } else if (leftover.size() > 65536) { // too large, process all to avoid memory blow
+                countText(leftover);
+                leftover.clear();
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastPublish >= std::chrono::milliseconds(publishIntervalMs)) {
+                publish(consumedBytes(stream, fileSize), fileSize, preview, false);
+                lastPublish = now;
+            }
+        }
+        const bool finished = !stopRequested;
+        if (finished) countText(leftover);
+        publish(finished ? fileSize : consumedBytes(stream, fileSize), fileSize, preview, finished);
+        file.close();
+    }
+
+    // bytes actually decoded so far; file.pos() runs ahead by QTextStream's read-ahead buffer,
+    // which is most of a small file. stream.pos() has to re-decode that buffer, so it is only
+    // called when publishing.
+    static qint64 consumedBytes(QTextStream &stream, qint64 fileSize) {
+        return qBound<qint64>(0, stream.pos(), fileSize);
+    }
+
+    // tokens are addressed in place inside text; no per-token QString/QByteArray/std::string.
+    // Hand-rolled scan equivalent to "(\p{Han}+)|(\w+)" with ASCII \w: a Han run goes to the
+    // segmenter, a run of [A-Za-z0-9_] is one token, everything else (é, Cyrillic, ...) is skipped.
+    void countText(const QString &text) {
+        const QChar *base = text.constData();
+        const int n = text.size();
+        const ChineseSegmenter &segmenter = sharedSegmenter();
+        int step = 0;
+        for (int i = 0; i < n;) {
+            const char32_t c = codePointAt(base, n, i, step);
+            const bool han = isHanChar(c);
+            if (!han && !isWordChar(c)) {
+                i += step;
+                continue;
+            }
+            int j = i + step;
+            while (j < n) {
+                const char32_t d = codePointAt(base, n, j, step);
+                if (han ? !isHanChar(d) : !isWordChar(d)) break;
+                j += step;
+            }
+            if (han) {
+                spans.clear();
+                segmenter.segmentSpans(base + i, j - i, spans);
+                for (const auto &sp : spans) countToken(base + i + sp.first, sp.second);
+            } else {
+                countToken(base + i, j - i);
+            }
+            i = j;
+        }
+    }
+
+    // UTF-16 -> UTF-8 into a reused buffer, then a single interner probe
+    void countToken(const QChar *s, int n) {
+        utf8.clear();
+        for (int i = 0; i < n; ++i) {
+            uint32_t c = s[i].unicode();
+            if (QChar::isHighSurrogate(c) && i + 1 < n && s[i + 1].isLowSurrogate()) {
+                c = QChar::surrogateToUcs4(s[i].unicode(), s[i + 1].unicode());
+                ++i;
+            }
+            if (c < 0x80) {
+                utf8 += (char)c;
+            } else if (c < 0x800) {
+                utf8 += (char)(0xC0 | c >> 6);
+                utf8 += (char)(0x80 | (c & 0x3F));
+            } else if (c < 0x10000) {
+                utf8 += (char)(0xE0 | c >> 12);
+                utf8 += (char)(0x80 | (c >> 6 & 0x3F));
+                utf8 += (char)(0x80 | (c & 0x3F));
+            } else {
+                utf8 += (char)(0xF0 | c >> 18);
+                utf8 += (char)(0x80 | (c >> 12 & 0x3F));
+                utf8 += (char)(0x80 | (c >> 6 & 0x3F));
+                utf8 += (char)(0x80 | (c & 0x3F));
+            }
+        }
+        counts.increment(utf8);
+    }
+
+    void publish(qint64 bytesRead, qint64 fileSize, const QString &preview, bool finished) {
+        // the counter keeps entries ordered by count, reading the top costs O(snapshotTopN)
+        FreqSnapshot &snap = snapshots.back();
+        snap.top.clear();
+        counts.forEachTop(snapshotTopN, [&snap](std::string_view key, size_t n) { snap.top.emplace_back(std::string(key), n); });
+        snap.distinct = counts.size();
+        snap.totalTokens = counts.totalCount();
+        snap.approximate = counts.approximate();
+        snap.maxError = counts.maxError();
+        snap.bytesRead = bytesRead;
+        snap.fileSize = fileSize;
+        snap.preview = preview;
+        snap.finished = finished;
+        snapshots.publish();
+    }
+
+    QFile file;
+    std::thread worker;
+    std::atomic<bool> stopRequested{false};
+    TopKCounter counts; // worker thread only
+    std::vector<std::pair<int, int>> spans;
+    std::string utf8;
+    SnapshotBuffer<FreqSnapshot> snapshots;
+};
 
 class StreamFreqWindow : public QMainWindow {
     Q_OBJECT
@@ -70,6 +600,17 @@ public:
         speedLay->addWidget(speedLabel);
         speedLay->addWidget(speedSlider, 1);
         speedLay->addWidget(speedValueLabel);
+        // approximate mode: Space-Saving with a fixed number of tracked words
+        approxCheck = new QCheckBox("近似统计（固定内存）");
+        approxCheck->setToolTip("只保留固定数量的词条（Space-Saving），计数为上界，误差不超过 总词数/容量");
+        approxCapacity = new QSpinBox();
+        approxCapacity->setRange(1000, 10000000);
+        approxCapacity->setSingleStep(10000);
+        approxCapacity->setValue(100000);
+        approxCapacity->setEnabled(false);
+        connect(approxCheck, &QCheckBox::toggled, approxCapacity, &QSpinBox::setEnabled);
+        speedLay->addWidget(approxCheck);
+        speedLay->addWidget(approxCapacity);
         mainLay->addLayout(speedLay);
 
         // status line
@@ -130,23 +671,10 @@ public:
         connect(btnStop, &QPushButton::clicked, this, &StreamFreqWindow::onStop);
         connect(speedSlider, &QSlider::valueChanged, this, &StreamFreqWindow::onSpeedChanged);
 
-        // timer: use single-shot reads so we can pause between small batches
-        readTimer = new QTimer(this);
-        readTimer->setSingleShot(true);
-        connect(readTimer, &QTimer::timeout, this, &StreamFreqWindow::readChunk);
-        pauseTimer = new QTimer(this);
-        pauseTimer->setSingleShot(true);
-        connect(pauseTimer, &QTimer::timeout, this, &StreamFreqWindow::resumeRead);
-
-        // update UI timer
+        // update UI timer: only renders the latest snapshot published by the counting engine
         uiTimer = new QTimer(this);
         uiTimer->setInterval(500); // 500ms 更新展示（更频繁，更流畅）
-        connect(uiTimer, &QTimer::timeout, this, &StreamFreqWindow::updateTable);
-
-        // defaults
-        chunkSize = 4096;
-        totalBytes = 0;
-        fileSize = 0;
+        connect(uiTimer, &QTimer::timeout, this, &StreamFreqWindow::pollEngine);
 
         uiTimer->start();
         // apply initial slider setting
@@ -159,19 +687,11 @@ private slots:
         if (!fn.isEmpty()) pathEdit->setText(fn);
     }
 
-    void resumeRead() {
-        if (file.isOpen()) readChunk();
-    }
-
     void onSpeedChanged(int v) {
         // show value
         if (speedValueLabel) speedValueLabel->setText(QString::number(v));
-        // map slider value to speed factor (50 -> 1.0)
+        // map slider value to speed factor (50 -> 1.0); reading itself is no longer throttled
         qreal factor = v / 50.0;
-        // adjust read batch word count
-        readWordsPerStep = std::max(1, (int)qRound(30 * factor));
-        // shorten pause as factor increases
-        pauseDurationMs = std::clamp((int)qRound(300 / factor), 50, 2000);
         // adjust animation duration (faster when factor larger)
         animationDurationMs = std::clamp((int)qRound(900 / factor), 100, 2000);
         if (chart) chart->setAnimationDuration(animationDurationMs);
@@ -184,235 +704,69 @@ private slots:
     void onStart() {
         QString fn = pathEdit->text();
         if (fn.isEmpty()) { QMessageBox::warning(this, "警告", "请选择文件"); return; }
-        file.setFileName(fn);
-        if (!file.open(QIODevice::ReadOnly)) { QMessageBox::warning(this, "警告", "无法打开文件"); return; }
-        if (textStream) { delete textStream; textStream = nullptr; }
-        textStream = new QTextStream(&file);
-        totalBytes = 0;
-        fileSize = file.size();
-        leftover.clear();
-        freqMap.clear();
+        engine.reset();
+        auto next = std::make_unique<FreqCountEngine>(approxCheck->isChecked() ? (size_t)approxCapacity->value() : 0);
+        if (!next->start(fn)) { QMessageBox::warning(this, "警告", "无法打开文件"); return; }
+        engine = std::move(next);
         // clear previous preview when starting a new run
-        initialPreview.clear();
         previewEdit->clear();
+        shownPreviewChars = 0;
         statusLabel->setText("读取中...");
         progress->setValue(0);
-        readChunk();
         uiTimer->start();
-        // enable/disable buttons (using findChildren below)
-        // simple enable/disable via find
-        auto btns = findChildren<QPushButton*>();
-        for (QPushButton *b : btns) {
-            if (b->text() == "开始") b->setEnabled(false);
-            if (b->text() == "停止") b->setEnabled(true);
-        }
+        setRunning(true);
     }
 
     void onStop() {
-        readTimer->stop();
-        file.close();
-        if (textStream) { delete textStream; textStream = nullptr; }
-        statusLabel->setText("已停止");
-        auto btns = findChildren<QPushButton*>();
-        for (QPushButton *b : btns) {
-            if (b->text() == "开始") b->setEnabled(true);
-            if (b->text() == "停止") b->setEnabled(false);
+        if (engine) {
+            engine->stop();
+            if (const FreqSnapshot *snap = engine->poll()) updateTable(*snap);
+            engine.reset();
         }
+        statusLabel->setText("已停止");
+        setRunning(false);
     }
 
-    void readChunk() {
-        if (!file.isOpen()) { readTimer->stop(); return; }
-        if (!textStream) textStream = new QTextStream(&file);
-        // accumulate until we have enough words
-        QString acc;
-        QRegularExpression reTokens("(\\p{Han}+)|(\\w+)");
-        int tokenCount = 0;
-        while (tokenCount < readWordsPerStep) {
-            QString piece = textStream->read((qint64)readBatchCharSize);
-            if (piece.isNull() || piece.isEmpty()) break;
-            acc += piece;
-            // count tokens in acc
-            auto itc = reTokens.globalMatch(acc);
-            tokenCount = 0;
-            while (itc.hasNext()) { itc.next(); tokenCount++; if (tokenCount >= readWordsPerStep) break; }
-            if (tokenCount >= readWordsPerStep) break;
-            // if piece smaller than batch, probably EOF soon - continue loop to break
-        }
-        QString chunk = acc;
-        if (chunk.isNull() || chunk.isEmpty()) {
-            // finished - process any leftover characters before closing
-            QString proc = leftover;
-            leftover.clear();
-            if (!proc.isEmpty()) {
-                QString text = proc;
-                // preserve beginning preview (keep up to previewMaxChars)
-                if (initialPreview.size() < previewMaxChars) {
-                    int need = previewMaxChars - initialPreview.size();
-                    initialPreview += text.left(need);
-                    previewEdit->setPlainText(initialPreview);
-                }
-                QRegularExpression re("(\\p{Han}+)|(\\w+)");
-                auto it = re.globalMatch(text);
-                while (it.hasNext()) {
-                    QRegularExpressionMatch m = it.next();
-                    QString token;
-                    if (!m.captured(1).isEmpty()) {
-                        QString chineseSeq = m.captured(1);
-                        QStringList segs = segmentChinese(chineseSeq);
-                        for (const QString &s : segs) {
-                            if (s.isEmpty()) continue;
-                            QByteArray ba = s.toUtf8();
-                            std::string key(ba.constData(), (size_t)ba.size());
-                            freqMap[key]++;
-                        }
-                        continue;
-                    } else if (!m.captured(2).isEmpty()) {
-                        token = m.captured(2);
-                    }
-                    if (token.isEmpty()) continue;
-                    QByteArray ba = token.toUtf8();
-                    std::string key(ba.constData(), (size_t)ba.size());
-                    freqMap[key]++;
-                }
-            }
-            // finished
-            readTimer->stop();
-            file.close();
-            if (textStream) { delete textStream; textStream = nullptr; }
-            statusLabel->setText("读取完成");
-            progress->setValue(100);
-            updateTable();
-            return;
-        }
-
-        // account for bytes read for progress (approximate)
-        totalBytes += chunk.toUtf8().size();
-        if (fileSize>0) progress->setValue((int)(100.0 * totalBytes / fileSize));
-
-        // Append to initial preview from raw chunk so right preview updates quickly
-        if (initialPreview.size() < previewMaxChars) {
-            int need = previewMaxChars - initialPreview.size();
-            if (need > 0 && !chunk.isEmpty()) {
-                initialPreview += chunk.left(need);
-                previewEdit->setPlainText(initialPreview);
-            }
+    void pollEngine() {
+        if (!engine) return;
+        const FreqSnapshot *snap = engine->poll();
+        if (!snap) return;
+        if (snap->fileSize > 0) progress->setValue((int)(100.0 * snap->bytesRead / snap->fileSize));
+        // preview grows only until previewMaxChars, skip the reset once it is complete
+        if (shownPreviewChars != snap->preview.size()) {
+            previewEdit->setPlainText(snap->preview);
+            shownPreviewChars = snap->preview.size();
         }
-
-        // append chunk to leftover (QString) and process up to last ASCII punctuation/space boundary
-        leftover.append(chunk);
-        int lastSep = -1;
-        for (int i = leftover.size()-1; i >= 0 && i >= leftover.size()-64; --i) {
-            QChar c = leftover.at(i);
-            if (c.isSpace() || c == ',' || c == '.' || c == ';' || c == ':' || c == '!' || c == '?' || c == '(' || c == ')' || c == '"' || c == '\'') { lastSep = i; break; }
+        updateTable(*snap);
+        // Space-Saving keeps only the tracked words: the table size is a lower bound on distinct words
+        QString status = !snap->finished ? QString("读取中...")
+                         : snap->approximate ? QString("读取完成，跟踪 %1 个词条（不同的词至少这么多）").arg((qulonglong)snap->distinct)
+                                             : QString("读取完成，共 %1 个不同的词").arg((qulonglong)snap->distinct);
+        if (snap->approximate) {
+            status += QString("（近似：计数至多高估 %1，总词数 %2）")
+                          .arg((qulonglong)snap->maxError).arg((qulonglong)snap->totalTokens);
         }
-        QString proc;
-        if (lastSep>=0) { proc = leftover.left(lastSep+1); leftover = leftover.mid(lastSep+1); }
-        else if (leftover.size() > 65536) { // too large, process all to avoid memory blow
-            proc = leftover;
-            leftover.clear();
-        } else {
-            proc.clear();
-        }
-
-        if (!proc.isEmpty()) {
-            QString text = proc;
-            if (initialPreview.size() < previewMaxChars) {
-                int need = previewMaxChars - initialPreview.size();
-                initialPreview += text.left(need);
-                previewEdit->setPlainText(initialPreview);
-            }
-            QRegularExpression re("(\\p{Han}+)|(\\w+)");
-            auto it = re.globalMatch(text);
-            while (it.hasNext()) {
-                QRegularExpressionMatch m = it.next();
-                QString token;
-                if (!m.captured(1).isEmpty()) {
-                    QString chineseSeq = m.captured(1);
-                    QStringList segs = segmentChinese(chineseSeq);
-                    for (const QString &s : segs) {
-                        if (s.isEmpty()) continue;
-                        QByteArray ba = s.toUtf8();
-                        std::string key(ba.constData(), (size_t)ba.size());
-                        freqMap[key]++;
-                    }
-                    continue;
-                } else if (!m.captured(2).isEmpty()) {
-                    token = m.captured(2);
-                }
-                if (token.isEmpty()) continue;
-                QByteArray ba = token.toUtf8();
-                std::string key(ba.constData(), (size_t)ba.size());
-                freqMap[key]++;
-            }
-        }
-
-        // update display after this small batch
-        updateTable();
-
-        // pause reading for a bit before resuming
-        pauseTimer->start(pauseDurationMs);
-    }
-
-    // Try to segment Chinese text using external jieba_segment.py (if python + jieba available).
-    // Falls back to single-character tokens when helper is not available.
-    QStringList segmentChinese(const QString &text) {
-        QStringList out;
-        // helper path next to executable
-        QString helper = QCoreApplication::applicationDirPath() + QDir::separator() + "jieba_segment.py";
-        if (QFile::exists(helper)) {
-            QProcess p;
-            QString python = "python"; // assume python in PATH
-            QStringList args;
-            args << helper;
-            p.start(python, args);
-            if (!p.waitForStarted(3000)) return fallbackCharSplit(text);
-            QByteArray in = text.toUtf8();
-            p.write(in);
-            p.closeWriteChannel();
-            if (!p.waitForFinished(5000)) return fallbackCharSplit(text);
-            if (p.exitCode() != 0) return fallbackCharSplit(text);
-            QByteArray outBytes = p.readAllStandardOutput();
-            QString outStr = QString::fromUtf8(outBytes).trimmed();
-            if (outStr.isEmpty()) return fallbackCharSplit(text);
-            for (const QString &tok : outStr.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts)) {
-                // skip pure-punctuation tokens (中文标点/其他标点)
-                bool allPunct = true;
-                for (QChar c : tok) {
-                    QChar::Category cat = c.category();
-                    if (!(cat == QChar::Punctuation_Connector || cat == QChar::Punctuation_Dash ||
-                          cat == QChar::Punctuation_Open || cat == QChar::Punctuation_Close ||
-                          cat == QChar::Punctuation_InitialQuote || cat == QChar::Punctuation_FinalQuote ||
-                          cat == QChar::Punctuation_Other)) { allPunct = false; break; }
-                }
-                if (tok.isEmpty() || allPunct) continue;
-                out << tok;
-            }
-            return out;
+        statusLabel->setText(status);
+        if (snap->finished) {
+            progress->setValue(100);
+            engine.reset();
+            setRunning(false);
         }
-        return fallbackCharSplit(text);
     }
 
-    QStringList fallbackCharSplit(const QString &text) {
-        QStringList lst;
-        for (QChar c : text) {
-            if (c.isSpace()) continue;
-            QChar::Category cat = c.category();
-            bool isPunct = (cat == QChar::Punctuation_Connector || cat == QChar::Punctuation_Dash ||
-                            cat == QChar::Punctuation_Open || cat == QChar::Punctuation_Close ||
-                            cat == QChar::Punctuation_InitialQuote || cat == QChar::Punctuation_FinalQuote ||
-                            cat == QChar::Punctuation_Other);
-            if (isPunct) continue;
-            lst << QString(c);
+private:
+    void setRunning(bool running) {
+        // enable/disable buttons (using findChildren below)
+        auto btns = findChildren<QPushButton*>();
+        for (QPushButton *b : btns) {
+            if (b->text() == "开始") b->setEnabled(!running);
+            if (b->text() == "停止") b->setEnabled(running);
         }
-        return lst;
     }
 
-    void updateTable() {
-        // produce vector of pairs and sort by freq
-        std::vector<std::pair<std::string,size_t>> vec;
-        vec.reserve(freqMap.size());
-        for (auto &p : freqMap) vec.emplace_back(p.first, p.second);
-        std::sort(vec.begin(), vec.end(), [](auto &a, auto &b){ return a.second > b.second; });
+    void updateTable(const FreqSnapshot &snap) {
+        // snapshot entries are already the top entries sorted by freq
+        const auto &vec = snap.top;
 
         // show top 200
         int showN = std::min((size_t)200, vec.size());
@@ -504,6 +858,8 @@ private:
     QChartView *chartView;
     QSlider *speedSlider;
     QLabel *speedValueLabel;
+    QCheckBox *approxCheck;
+    QSpinBox *approxCapacity;
 
     // live chart objects for smooth updates (Bar Chart Race)
     QBarSeries *liveSeries = nullptr;
@@ -518,28 +874,16 @@ private:
     QVector<qreal> prevValues;
     QStringList prevCategories;
 
-    QTimer *readTimer;
-    QTimer *pauseTimer;
     QTimer *uiTimer;
-    QTextStream *textStream = nullptr;
-    QFile file;
-    QString leftover;
-    size_t chunkSize;
-    int readWordsPerStep = 30; // read 30 words per batch
-    int readBatchCharSize = 256; // read this many chars per small read while accumulating words
-    int pauseDurationMs = 300; // pause 300ms between batches (shorter)
-    qint64 totalBytes;
-    qint64 fileSize;
-    QString initialPreview;
-    int previewMaxChars = 20000;
-
-    StringFreqMap freqMap;
+    std::unique_ptr<FreqCountEngine> engine;
+    int shownPreviewChars = 0;
 };
 
 #include "main.moc"
 
 int main(int argc, char **argv) {
     QApplication app(argc, argv);
+    sharedSegmenter(); // load the dictionary once before any counting starts
     StreamFreqWindow w;
     w.show();
     return app.exec();
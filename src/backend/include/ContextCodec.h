@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "HuffmanCodec.h"
+
+// 一阶上下文哈夫曼：下一个字符的分布强烈依赖前一个字符（英文的 "q"->"u"，中文的常见词组），
+// 单张全局码表（HuffmanTree::buildForText）无法利用这一点。
+// 这里按"前一个符号"划分上下文，把分布相近的上下文聚成不超过 kMaxContextTables 类，每类一张码表。
+// 文本按块编码，每块自带 符号表 + 上下文映射（前一符号 -> 码表编号）+ 各码表码长，
+// 解码时按前一符号查映射数组直接切换码表，仍是查表解码。
+//
+// 块格式（整数均为 LEB128）：
+//   符号数 | 不同符号数 n | 符号升序差分 | 码表数 K | 默认码表 | 例外数 | (上下文差分, 码表编号)...
+//   | K 张码长表（字母表为块内符号下标 0..n-1）| u64 位数 | 打包位流
+// 上下文编号为前一符号的块内下标，块首符号使用特殊上下文 n。
+
+constexpr unsigned kMaxContextTables = 8;
+constexpr uint32_t kContextBlockSymbols = 1u << 20;
+// 平均每张码表至少服务这么多符号，否则码表本身的开销抵消收益
+constexpr uint32_t kSymbolsPerContextTable = 2048;
+
+class ContextTextCodec {
+public:
+    // 之后的 encode（Encoding）/ decode（Decoding）按符号汇报进度并响应取消；nullptr 关闭
+    void setProgress(JobProgress* progress) { m_progress = progress; }
+
+    // text 为 UTF-16 码元序列（均 < HuffmanEncoder::kTextAlphabet），追加写入 out
+    bool encode(const std::wstring& text, std::vector<uint8_t>& out);
+    // 读取 encode 写出的全部块，结果写入 text（会先清空）
+    bool decode(const uint8_t*& p, const uint8_t* end, std::wstring& text);
+
+private:
+    // offset 为块首在整段文本中的位置，用于汇报进度
+    bool encodeBlock(const wchar_t* text, size_t count, size_t offset, std::vector<uint8_t>& out);
+    bool decodeBlock(const uint8_t*& p, const uint8_t* end, std::wstring& text);
+    void clusterContexts(unsigned tableCount);
+
+    // 编码
+    std::vector<int32_t> m_localIndex;     // UTF-16 码元 -> 块内下标
+    std::vector<uint32_t> m_symbols;       // 块内下标 -> 码元
+    std::vector<uint32_t> m_local;         // 块内文本的下标序列
+    std::vector<uint64_t> m_pairs;         // (上下文 << 32 | 符号) 排序后统计
+    std::vector<uint32_t> m_pairSym;
+    std::vector<uint32_t> m_pairCount;
+    std::vector<uint32_t> m_ctxBegin;      // 上下文 c 的统计位于 [m_ctxBegin[c], m_ctxBegin[c + 1])
+    std::vector<uint64_t> m_ctxTotal;
+    std::vector<uint8_t> m_ctxTable;       // 上下文 -> 码表编号
+    std::vector<HuffmanEncoder> m_encoders;
+
+    // 解码
+    std::vector<HuffmanDecoder> m_decoders;
+
+    JobProgress* m_progress = nullptr;
+};
@@ -0,0 +1,118 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 整数键的开放寻址哈希表（线性探测，负载不超过 1/2）
+// std::unordered_map 每个元素一个堆节点，查找要沿桶链逐个解引用；
+// 这里键值连续存放在一个数组里，命中通常就在同一条缓存行内。
+// 只支持插入/查找/清空（码表构建后不再删除），键 kEmptyKey 保留作空槽标记。
+// 仅依赖标准库，UIwithPIC.cpp 与 src/backend 共用。
+template <typename V>
+class FlatHashMap {
+public:
+    static constexpr uint64_t kEmptyKey = UINT64_MAX;
+
+    V* find(uint64_t key) {
+        if (m_size == 0) return nullptr;
+        for (size_t i = slotOf(key);; i = (i + 1) & m_mask) {
+            if (m_slots[i].key == key) return &m_slots[i].value;
+            if (m_slots[i].key == kEmptyKey) return nullptr;
+        }
+    }
+    const V* find(uint64_t key) const { return const_cast<FlatHashMap*>(this)->find(key); }
+
+    // 不存在时插入默认值
+    V& operator[](uint64_t key) {
+        if ((m_size + 1) * 2 > m_slots.size()) grow();
+        size_t i = slotOf(key);
+        while (m_slots[i].key != key && m_slots[i].key != kEmptyKey) i = (i + 1) & m_mask;
+        if (m_slots[i].key == kEmptyKey) {
+            m_slots[i].key = key;
+            m_slots[i].value = V();
+            ++m_size;
+        }
+        return m_slots[i].value;
+    }
+
+    // 清空内容，保留容量
+    void clear() {
+        for (Slot& s : m_slots) s.key = kEmptyKey;
+        m_size = 0;
+    }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    // f(key, value)，顺序不确定
+    template <typename F>
+    void forEach(F&& f) const {
+        for (const Slot& s : m_slots) {
+            if (s.key != kEmptyKey) f(s.key, s.value);
+        }
+    }
+
+private:
+    struct Slot {
+        uint64_t key = kEmptyKey;
+        V value = V();
+    };
+
+    // 码字键的低位高度相关，先做一次 64 位混合（MurmurHash3 的 fmix64）
+    size_t slotOf(uint64_t key) const {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return (size_t)key & m_mask;
+    }
+
+    void grow() {
+        std::vector<Slot> old;
+        old.swap(m_slots);
+        m_slots.assign(old.empty() ? 16 : old.size() * 2, Slot());
+        m_mask = m_slots.size() - 1;
+        m_size = 0;
+        for (const Slot& s : old) {
+            if (s.key != kEmptyKey) (*this)[s.key] = s.value;
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    size_t m_mask = 0;
+    size_t m_size = 0;
+};
+
+// 码字打包为整数键：高 8 位为码长，低 56 位为码字（先出现的位在高位）。
+// 这样 "01" 与 "001" 不会冲突，码长 0 的码字（单叶子树）对应键 0。
+constexpr unsigned kMaxPackedCodeLen = 56;
+
+inline uint64_t packCodeKey(uint64_t bits, unsigned len) {
+    return (uint64_t)len << kMaxPackedCodeLen | bits;
+}
+inline unsigned packedCodeLen(uint64_t key) { return (unsigned)(key >> kMaxPackedCodeLen); }
+inline uint64_t packedCodeBits(uint64_t key) { return key & ((1ULL << kMaxPackedCodeLen) - 1); }
+
+// "0101" 形式的码字串与打包键互转；含 '0'/'1' 以外字符或超长时返回 false
+inline bool codeStringToKey(const std::wstring& code, uint64_t& key) {
+    if (code.size() > kMaxPackedCodeLen) return false;
+    uint64_t bits = 0;
+    for (wchar_t c : code) {
+        if (c != L'0' && c != L'1') return false;
+        bits = bits << 1 | (uint64_t)(c == L'1');
+    }
+    key = packCodeKey(bits, (unsigned)code.size());
+    return true;
+}
+inline std::wstring codeKeyToString(uint64_t key) {
+    unsigned len = packedCodeLen(key);
+    uint64_t bits = packedCodeBits(key);
+    std::wstring code(len, L'0');
+    for (unsigned i = 0; i < len; ++i) {
+        if (bits >> (len - 1 - i) & 1) code[i] = L'1';
+    }
+    return code;
+}
+
+#endif // FLAT_HASH_MAP_H
@@ -0,0 +1,225 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "JobProgress.h"
+
+// 可复用的哈夫曼编码/解码上下文
+// HuffmanTree 每次构建都会 new 全部节点并重建四张 unordered_map；
+// 这里的 HuffmanEncoder / HuffmanDecoder 把频率表、节点池、码表和输出缓冲都作为成员保留，
+// reset() 只清空内容不释放容量，同一线程反复编码时热路径上不再触发内存分配。
+// 上下文本身不是线程安全的，每个线程持有自己的实例（backend_api 内使用 thread_local）。
+
+// 小端序整数读写（.phuf 等二进制格式共用）
+inline void appendLE(std::vector<uint8_t>& out, uint64_t v, unsigned bytes) {
+    for (unsigned i = 0; i < bytes; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+inline bool readLE(const uint8_t*& p, const uint8_t* end, uint64_t& v, unsigned bytes) {
+    if ((size_t)(end - p) < bytes) return false;
+    v = 0;
+    for (unsigned i = 0; i < bytes; ++i) v |= (uint64_t)p[i] << (8 * i);
+    p += bytes;
+    return true;
+}
+// LEB128 变长整数（每字节 7 位，高位为续位），用于符号表、上下文映射等小整数序列
+inline void appendVarint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+inline bool readVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (p >= end) return false;
+        uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// 单个符号的码字（低 len 位有效，高位在前写出）
+struct HuffmanCode {
+    uint32_t bits = 0;
+    uint8_t len = 0;
+};
+
+// MSB 优先的位流写入器（与 UIwithPIC.cpp 中 .phuf 的位打包顺序一致）
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+    void write(uint32_t bits, unsigned len);
+    // 补齐最后一个不完整字节（低位补 0）
+    void flush();
+    uint64_t bitCount() const { return m_bitCount; }
+
+private:
+    std::vector<uint8_t>& m_out;
+    uint64_t m_acc = 0;
+    unsigned m_accBits = 0;
+    uint64_t m_bitCount = 0;
+};
+
+// MSB 优先的位流读取器，越过有效位之后 peek 返回的位补 0
+class BitReader {
+public:
+    BitReader(const uint8_t* data, uint64_t bitCount)
+        : m_data(data), m_bytes((bitCount + 7) / 8), m_bitCount(bitCount) {}
+
+    uint32_t peek(unsigned n) const;  // n <= 32
+    void skip(unsigned n) { m_pos += n; }
+    uint32_t read(unsigned n) { uint32_t v = peek(n); m_pos += n; return v; }
+    uint64_t position() const { return m_pos; }
+    uint64_t remaining() const { return m_pos < m_bitCount ? m_bitCount - m_pos : 0; }
+
+private:
+    const uint8_t* m_data;
+    uint64_t m_bytes;
+    uint64_t m_bitCount;
+    uint64_t m_pos = 0;
+};
+
+// 游程长度码：沿用 DEFLATE 长度码（257..285）的 29 个分段，覆盖 3..258。
+// 游程符号排在字面量之后（符号 = 字面量字母表大小 + 分段下标），码字后紧跟 extra 位，
+// 含义是"重复前一个字面量 len 次"；更长的游程拆成多个游程符号。
+constexpr unsigned kRunCodeCount = 29;
+constexpr uint32_t kMinRun = 3;
+constexpr uint32_t kMaxRun = 258;
+unsigned runLengthCode(uint32_t len);  // kMinRun <= len <= kMaxRun
+uint32_t runLengthBase(unsigned code);
+unsigned runLengthExtra(unsigned code);
+
+class HuffmanEncoder {
+public:
+    // 码长上限；超过时按 bzip2 的做法把频率减半后重建
+    static constexpr unsigned kMaxCodeLen = 32;
+    // 文本字母表按 UTF-16 码元计（与 HuffmanTree 的 wchar_t 一致）
+    static constexpr uint32_t kTextAlphabet = 0x10000;
+
+    HuffmanEncoder() = default;
+
+    // 之后的 encodeBytes / encodeTextUtf8 按块汇报进度并响应取消；nullptr 关闭
+    void setProgress(JobProgress* progress) { m_progress = progress; }
+
+    // 清空统计并设置字母表大小（只增长容量，不释放）
+    void reset(uint32_t alphabetSize);
+    void count(uint32_t sym) {
+        if (m_freq[sym]++ == 0) m_used.push_back(sym);
+    }
+    void count(uint32_t sym, uint64_t n) {
+        if (n == 0) return;
+        if (m_freq[sym] == 0) m_used.push_back(sym);
+        m_freq[sym] += n;
+    }
+
+    // 由当前频率生成范式哈夫曼码（同频时叶子优先、符号小者优先，规则同 HuffmanTree）
+    bool buildCodes(unsigned maxLen = kMaxCodeLen);
+
+    uint32_t alphabetSize() const { return m_alphabet; }
+    uint64_t frequency(uint32_t sym) const { return m_freq[sym]; }
+    const HuffmanCode& code(uint32_t sym) const { return m_codes[sym]; }
+    // buildCodes 之后按符号升序排列
+    const std::vector<uint32_t>& usedSymbols() const { return m_used; }
+    // 按当前频率编码全部符号所需的位数
+    uint64_t encodedBits() const;
+
+    // 最近一次 buildCodes 的建树过程（可视化用）：节点 0..k-1 为叶子，符号依次为 mergeLeaves()
+    // （按 (频率, 符号) 升序）；第 i 次合并 mergeSteps()[i] 产生节点 k+i，left 为先取出的一个，
+    // weight 为原始频率之和（限长重建时也是）。叶子深度即码长，但码字随后按范式规则分配，
+    // 不一定等于从根沿 left=0 / right=1 走到叶子的路径。只有一个符号时没有合并。
+    struct Merge {
+        uint32_t left;
+        uint32_t right;
+        uint64_t weight;
+    };
+    const std::vector<uint32_t>& mergeLeaves() const { return m_mergeLeaves; }
+    const std::vector<Merge>& mergeSteps() const { return m_merges; }
+
+    void put(uint32_t sym, BitWriter& bw) const {
+        const HuffmanCode& c = m_codes[sym];
+        bw.write(c.bits, c.len);
+    }
+
+    // 码长表序列化：逐符号一个字节的码长，连续的 0 写成 (0, 个数-1)
+    void writeLengths(std::vector<uint8_t>& out) const;
+
+    // 字节流编码，追加 <码长表><u64 字节数><u64 位数><打包位流> 到 out
+    // runLength 为 true 时字母表为 256 个字面量 + kRunCodeCount 个游程符号
+    bool encodeBytes(const uint8_t* data, size_t size, std::vector<uint8_t>& out, bool runLength = false);
+
+    // 文本编码，输出与 backend_api::encodeTextUtf8 相同的 "<TEXT|码表>|<01位串>" 格式；
+    // runLength 为 true 时类型标记为 TEXTRLE，码表含游程符号，位串中游程符号后跟 extra 位。
+    // 返回内部缓冲的引用，下一次调用前有效。失败（含 BMP 以外的码元）时返回空串
+    const std::string& encodeTextUtf8(const std::string& utf8, bool runLength = false);
+
+private:
+    void computeLengths();
+    void assignCanonical();
+
+    uint32_t m_alphabet = 0;
+    std::vector<uint64_t> m_freq;
+    std::vector<uint32_t> m_used;
+    std::vector<HuffmanCode> m_codes;
+
+    // 节点池：前 k 个为叶子（按频率排序后），其后依次为合并产生的内部节点
+    std::vector<uint64_t> m_nodeFreq;
+    std::vector<uint32_t> m_nodeParent;
+    std::vector<uint32_t> m_nodeDepth;
+    std::vector<uint32_t> m_order;
+    std::vector<uint32_t> m_mergeLeaves;
+    std::vector<Merge> m_merges;
+
+    std::wstring m_wtext;
+    std::string m_out;
+    JobProgress* m_progress = nullptr;
+};
+
+class HuffmanDecoder {
+public:
+    // 快速查表一次解析的位数，更长的码字回退到逐位走前缀树
+    static constexpr unsigned kFastBits = 10;
+
+    HuffmanDecoder() = default;
+
+    // 之后的 decodeBytes / decodeTextUtf8 按块汇报进度并响应取消；nullptr 关闭
+    void setProgress(JobProgress* progress) { m_progress = progress; }
+
+    void reset();
+    // 插入一个码字；与已有码字构成前缀冲突时返回 false
+    bool addCode(uint32_t sym, uint32_t bits, unsigned len);
+    // 全部码字插入后调用，生成快速查找表
+    void finalize();
+
+    // 读取 writeLengths 写出的码长表并按范式规则重建码字（会先 reset）
+    bool readLengths(const uint8_t*& p, const uint8_t* end, uint32_t alphabetSize);
+
+    // 成功时写入 sym 并前移读取位置；遇到无效码字或位流截断返回 false
+    bool decodeSymbol(BitReader& br, uint32_t& sym) const;
+
+    // 解码 encodeBytes 写出的块，结果追加到 out，p 前移到块末尾；runLength 须与编码时一致
+    bool decodeBytes(const uint8_t*& p, const uint8_t* end, std::vector<uint8_t>& out, bool runLength = false);
+
+    // 解码 encodeTextUtf8 格式（兼容 HuffmanTree 序列化的非范式码表，按类型标记识别 TEXTRLE）
+    bool decodeTextUtf8(const std::string& combined, std::string& out);
+
+private:
+    // 解析 "<类型|符号|码字|...>|<01位串>"：载入码表并把位串打包到 m_packed
+    bool loadLegacy(const std::string& combined, uint64_t& bitCount);
+
+    struct FastEntry {
+        int32_t target = 0;  // <0: 叶子 ~符号；>0: 需要继续走的前缀树节点
+        uint8_t len = 0;     // 0 表示无效前缀
+    };
+
+    // 前缀树：m_child[2*node+bit]，0 为空，>0 为子节点下标，<0 为叶子 ~sym
+    std::vector<int32_t> m_child;
+    std::vector<FastEntry> m_fast;
+
+    std::vector<uint8_t> m_lens;
+    std::vector<uint8_t> m_packed;
+    std::wstring m_wtext;
+    JobProgress* m_progress = nullptr;
+};
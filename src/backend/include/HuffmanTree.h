@@ -11,6 +11,7 @@
 #include <windows.h>
 
 #include "HuffmanNode.h"
+#include "FlatHashMap.h"
 
 // 移除 using namespace std; 语句
 
@@ -21,14 +22,18 @@ std::wstring encodeImage(const std::vector<BYTE>& data, const std::unordered_map
 class HuffmanTree {
 private:
     HuffmanNode* root;
-    std::unordered_map<wchar_t, std::wstring> charToCode;  // 字符到编码的映射（文本）
-    std::unordered_map<std::wstring, wchar_t> codeToChar;   // 编码到字符的映射（文本）
-    std::unordered_map<BYTE, std::wstring> byteToCode;      // 字节到编码的映射（图片）
-    std::unordered_map<std::wstring, BYTE> codeToByte;     // 编码到字节的映射（图片）
+    // 码字一律以 packCodeKey(bits,len) 打包的整数存放（见 FlatHashMap.h），
+    // 解码时逐位累加整数键查表，不再拼接 wstring 再哈希
+    FlatHashMap<uint64_t> charToCode;  // 字符到编码的映射（文本）
+    FlatHashMap<wchar_t> codeToChar;   // 编码到字符的映射（文本）
+    FlatHashMap<uint64_t> byteToCode;  // 字节到编码的映射（图片）
+    FlatHashMap<BYTE> codeToByte;      // 编码到字节的映射（图片）
     std::vector<HuffmanNode*> leafnodes;
     bool isImageTree;  // 标记当前树是用于图片还是文本
 
     void destroyNode(HuffmanNode* node);
+    // 叶子到根回溯得到的码字；int 频率下树深不超过 46，放得进 kMaxPackedCodeLen
+    static uint64_t leafCodeKey(const HuffmanNode* leaf);
      // 后端内部维护的核心数据（编码时生成）
     std::wstring m_codeTableW;
     std::vector<uint8_t> m_imageBits;
@@ -0,0 +1,98 @@
+#ifndef IMAGE_FILTER_H
+#define IMAGE_FILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// 像素数据的可逆预测滤波（PNG 风格，逐行选择预测器）
+// 照片类图像相邻像素高度相关，直接对原始字节做哈夫曼几乎压不动；
+// 先用左/上/Paeth 预测同一通道的值，只编码残差，残差集中在 0 附近，分布更偏，码长明显变短。
+// 仅依赖标准库，UIwithPIC.cpp 与 src/backend 共用同一份实现。
+
+enum ImageFilterType : uint8_t {
+    IMAGE_FILTER_NONE = 0,
+    IMAGE_FILTER_LEFT = 1,   // 预测值 = 左侧像素同一通道
+    IMAGE_FILTER_UP = 2,     // 预测值 = 上一行同位置
+    IMAGE_FILTER_PAETH = 3,  // 左/上/左上 三者中最接近 a+b-c 的一个
+    IMAGE_FILTER_COUNT = 4
+};
+
+// 滤波结果布局：每行 1 字节滤波类型 + 该行残差
+inline size_t filteredImageSize(int width, int height, int bytesPerPixel) {
+    return (size_t)height * (1 + (size_t)width * bytesPerPixel);
+}
+
+inline uint8_t paethPredict(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a);
+    int pb = std::abs(p - b);
+    int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return (uint8_t)a;
+    if (pb <= pc) return (uint8_t)b;
+    return (uint8_t)c;
+}
+
+// row/prev 为当前行与上一行的原始像素（首行 prev 为 nullptr），i 为行内字节下标
+inline uint8_t predictImageByte(int type, const uint8_t* row, const uint8_t* prev, size_t i, int bytesPerPixel) {
+    int a = i >= (size_t)bytesPerPixel ? row[i - bytesPerPixel] : 0;
+    int b = prev ? prev[i] : 0;
+    int c = (prev && i >= (size_t)bytesPerPixel) ? prev[i - bytesPerPixel] : 0;
+    switch (type) {
+    case IMAGE_FILTER_LEFT: return (uint8_t)a;
+    case IMAGE_FILTER_UP: return (uint8_t)b;
+    case IMAGE_FILTER_PAETH: return paethPredict(a, b, c);
+    default: return 0;
+    }
+}
+
+// 对每一行分别尝试各预测器，选残差绝对值之和最小者（PNG 常用的启发式）
+// out 需要 filteredImageSize 字节
+inline void filterImageRows(const uint8_t* pixels, int width, int height, int bytesPerPixel, uint8_t* out) {
+    const size_t rowBytes = (size_t)width * bytesPerPixel;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* row = pixels + (size_t)y * rowBytes;
+        const uint8_t* prev = y > 0 ? row - rowBytes : nullptr;
+
+        int best = IMAGE_FILTER_NONE;
+        uint64_t bestCost = UINT64_MAX;
+        for (int type = IMAGE_FILTER_NONE; type < IMAGE_FILTER_COUNT; ++type) {
+            uint64_t cost = 0;
+            for (size_t i = 0; i < rowBytes && cost < bestCost; ++i) {
+                int8_t r = (int8_t)(row[i] - predictImageByte(type, row, prev, i, bytesPerPixel));
+                cost += (uint64_t)std::abs((int)r);
+            }
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = type;
+            }
+        }
+
+        uint8_t* dst = out + (size_t)y * (rowBytes + 1);
+        dst[0] = (uint8_t)best;
+        for (size_t i = 0; i < rowBytes; ++i) {
+            dst[1 + i] = (uint8_t)(row[i] - predictImageByte(best, row, prev, i, bytesPerPixel));
+        }
+    }
+}
+
+// filterImageRows 的逆过程；size 必须等于 filteredImageSize，遇到未知滤波类型返回 false
+inline bool unfilterImageRows(const uint8_t* filtered, size_t size, int width, int height, int bytesPerPixel, uint8_t* pixels) {
+    if (width < 0 || height < 0 || bytesPerPixel <= 0) return false;
+    if (size != filteredImageSize(width, height, bytesPerPixel)) return false;
+    const size_t rowBytes = (size_t)width * bytesPerPixel;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* src = filtered + (size_t)y * (rowBytes + 1);
+        uint8_t type = src[0];
+        if (type >= IMAGE_FILTER_COUNT) return false;
+        uint8_t* row = pixels + (size_t)y * rowBytes;
+        const uint8_t* prev = y > 0 ? row - rowBytes : nullptr;
+        // 预测只用到已还原的左侧与上一行，可以原地逐字节还原
+        for (size_t i = 0; i < rowBytes; ++i) {
+            row[i] = (uint8_t)(src[1 + i] + predictImageByte(type, row, prev, i, bytesPerPixel));
+        }
+    }
+    return true;
+}
+
+#endif // IMAGE_FILTER_H
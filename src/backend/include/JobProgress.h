@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// 长时间运行的后端调用的进度与取消标记
+// 调用方创建一个 JobProgress 传给 backend_api 的编码/解码/文件函数（可为 nullptr），
+// 其它线程（界面定时器、任务调度器）随时读取进度、请求取消。
+// 后端每处理完一块（kProgressBlock 个字节或符号）才更新一次计数并检查取消，
+// 逐字符的热循环里没有原子操作，也没有回调。被取消的调用按失败返回。
+struct JobProgress {
+    enum Phase : int {
+        Idle = 0,
+        Reading,    // 读输入文件（字节）
+        Analyzing,  // 统计频率（符号）
+        Encoding,   // 写位流（符号）
+        Decoding,   // 解码位流（位或输出字节）
+        Writing,    // 写输出文件（字节）
+        Done,
+    };
+
+    std::atomic<int> phase{Idle};
+    std::atomic<uint64_t> processed{0};  // 当前阶段已处理的量
+    std::atomic<uint64_t> total{0};      // 当前阶段的总量，未知时为 0
+    std::atomic<bool> cancelRequested{false};
+
+    void requestCancel() { cancelRequested.store(true, std::memory_order_relaxed); }
+    bool canceled() const { return cancelRequested.load(std::memory_order_relaxed); }
+    // 当前阶段完成的比例（0..1），总量未知时为 0
+    double fraction() const {
+        uint64_t t = total.load(std::memory_order_relaxed);
+        uint64_t d = processed.load(std::memory_order_relaxed);
+        return t == 0 ? 0.0 : (d >= t ? 1.0 : (double)d / (double)t);
+    }
+};
+
+constexpr size_t kProgressBlock = 1 << 16;
+
+// 以下供后端使用，progress 为 nullptr 时什么也不做；返回 false 表示已请求取消
+inline bool progressBegin(JobProgress* progress, JobProgress::Phase phase, uint64_t total) {
+    if (!progress) return true;
+    progress->processed.store(0, std::memory_order_relaxed);
+    progress->total.store(total, std::memory_order_relaxed);
+    progress->phase.store(phase, std::memory_order_relaxed);
+    return !progress->canceled();
+}
+inline bool progressAt(JobProgress* progress, uint64_t processed) {
+    if (!progress) return true;
+    progress->processed.store(processed, std::memory_order_relaxed);
+    return !progress->canceled();
+}
+inline void progressDone(JobProgress* progress) {
+    if (progress) progress->phase.store(JobProgress::Done, std::memory_order_relaxed);
+}
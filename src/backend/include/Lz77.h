@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "JobProgress.h"
+
+// LZ77 前端（哈希链匹配器），与 DEFLATE 同构：
+// 输入先切成 字面量 / (长度, 距离) 序列，再由 PhufCodec 用两张哈夫曼表（字面量+长度、距离）编码。
+// 纯 0 阶哈夫曼无法利用重复出现的短语，日志等重复度高的文本经过这一层后体积可再降数倍。
+
+// 压缩等级 1..9：等级越高窗口越大、每个位置回溯的候选越多，越慢但压缩率越高
+constexpr int kLz77MinLevel = 1;
+constexpr int kLz77MaxLevel = 9;
+constexpr int kLz77DefaultLevel = 6;
+constexpr unsigned kLz77MaxWindowBits = 20;
+
+struct Lz77Params {
+    unsigned windowBits = 15;   // 窗口 = 1 << windowBits 字节，即最大回溯距离
+    unsigned maxChain = 128;    // 每个位置最多比较的候选位置数
+    unsigned niceLength = 128;  // 匹配达到该长度即停止搜索
+    bool lazy = true;           // 惰性匹配：下一位置能匹配得更长时，当前位置先输出字面量
+};
+
+Lz77Params lz77ParamsForLevel(int level);
+
+// 距离码：前 4 个码各对应一个距离，之后每两个码共用一种 extra 位数（同 DEFLATE，扩展到 1 << kLz77MaxWindowBits）
+constexpr unsigned kDistCodeCount = 2 * kLz77MaxWindowBits;
+unsigned distanceCode(uint32_t dist);  // 1 <= dist <= 1 << kLz77MaxWindowBits
+uint32_t distanceBase(unsigned code);
+unsigned distanceExtra(unsigned code);
+
+struct Lz77Token {
+    uint32_t length = 0;  // 0 表示字面量，否则为匹配长度（kMinRun..kMaxRun，复用游程长度码）
+    uint32_t value = 0;   // 字面量字节或匹配距离
+};
+
+class Lz77Matcher {
+public:
+    // 之后的 parse 按输入字节汇报进度（Analyzing）并响应取消；nullptr 关闭
+    void setProgress(JobProgress* progress) { m_progress = progress; }
+
+    // 结果写入 tokens（会先清空）；哈希表与链表作为成员复用。被取消时返回 false
+    bool parse(const uint8_t* data, size_t size, const Lz77Params& params, std::vector<Lz77Token>& tokens);
+
+private:
+    void insert(const uint8_t* data, size_t pos);
+    uint32_t findMatch(const uint8_t* data, size_t size, size_t pos, const Lz77Params& params, uint32_t& dist) const;
+
+    std::vector<int32_t> m_head;  // 3 字节哈希 -> 最近出现的位置
+    std::vector<int32_t> m_prev;  // 位置 & 窗口掩码 -> 同一哈希的上一个位置
+    size_t m_windowMask = 0;
+    JobProgress* m_progress = nullptr;
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "HuffmanCodec.h"
+
+// 分块多码表哈夫曼（bzip2 的 selector 方案）
+// 整个输入只用一张码表时，文件头、正文、二进制附录等统计差异很大的部分只能共用一个折中分布。
+// 这里把输入切成独立的块，块内每 kMultiTableGroupSize 个符号为一组，
+// 为块构建至多 kMaxMultiTables 张候选码表，每组各自选用代价最小的一张，选择子随位流写出。
+// 码表通过"按当前码表给各组重新选表 -> 按选择结果重建码表"迭代 kMultiTableIterations 轮求得。
+// 每个块自带符号表与码表、记录自身字节数，解码时可以先扫描块边界再多线程并行解码。
+//
+// 流格式（整数均为 LEB128）：总符号数 | 块...
+// 块：符号数 | 块体字节数 | 块体
+// 块体：不同符号数 n | 符号升序差分 | 码表数 T | T 张码长表（字母表为块内下标 0..n-1）
+//       | u64 位数 | 打包位流（各组选择子：MTF 后一元码；随后是全部符号）
+
+constexpr unsigned kMaxMultiTables = 6;
+constexpr uint32_t kMultiTableGroupSize = 50;
+constexpr uint32_t kMultiTableBlockSymbols = 1u << 18;
+constexpr unsigned kMultiTableIterations = 4;
+
+class MultiTableCodec {
+public:
+    // 之后的 encode（Encoding）/ decode（Decoding）每个块汇报一次进度并响应取消；nullptr 关闭
+    void setProgress(JobProgress* progress) { m_progress = progress; }
+
+    // 字节序列（字母表 256），追加写入 out
+    bool encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+    // UTF-16 码元序列（均 < HuffmanEncoder::kTextAlphabet），追加写入 out
+    bool encode(const std::wstring& text, std::vector<uint8_t>& out);
+    // 读取 encode 写出的流，结果写入 out / text（会先清空），p 前移到流末尾；
+    // 多个块时按硬件线程数并行解码
+    bool decode(const uint8_t*& p, const uint8_t* end, std::vector<uint8_t>& out);
+    bool decode(const uint8_t*& p, const uint8_t* end, std::wstring& text);
+
+private:
+    struct BlockRef {
+        const uint8_t* body = nullptr;
+        const uint8_t* end = nullptr;
+        uint64_t offset = 0;  // 块内第一个符号在输出中的下标
+        uint32_t count = 0;
+    };
+    // 每个解码线程一份，块之间复用容量
+    struct BlockDecoder {
+        std::vector<HuffmanDecoder> tables;
+        std::vector<uint32_t> symbols;
+        std::vector<uint8_t> selectors;
+        std::vector<uint32_t> local;
+    };
+
+    template <typename Sym>
+    bool encodeAll(const Sym* data, size_t size, uint32_t alphabet, std::vector<uint8_t>& out);
+    template <typename Sym>
+    bool decodeAll(uint32_t alphabet, Sym* out);
+
+    bool encodeBlock(uint32_t alphabet, std::vector<uint8_t>& out);
+    void chooseTables(unsigned tableCount);
+    bool scanBlocks(const uint8_t*& p, const uint8_t* end, uint64_t& total);
+    static bool decodeBlock(const BlockRef& block, uint32_t alphabet, BlockDecoder& state);
+
+    // 编码：当前块的原始符号、块内下标、每组选用的码表
+    std::vector<uint32_t> m_block;
+    std::vector<int32_t> m_localIndex;
+    std::vector<uint32_t> m_symbols;
+    std::vector<uint32_t> m_local;
+    std::vector<uint8_t> m_selectors;
+    std::vector<uint8_t> m_lengths;  // m_lengths[t * n + s]：码表 t 下符号 s 的估计码长
+    std::vector<HuffmanEncoder> m_encoders;
+    std::vector<uint8_t> m_body;
+
+    // 解码
+    std::vector<BlockRef> m_blocks;
+    std::vector<BlockDecoder> m_workers;
+
+    JobProgress* m_progress = nullptr;
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "HuffmanCodec.h"
+#include "ContextCodec.h"
+#include "Lz77.h"
+#include "MultiTableCodec.h"
+#include "TextTokenizer.h"
+
+// .phuf 二进制容器（取代 "<IMAGE|码表>|<01位串>" 的宽字符串格式）
+// 头部：'P' 'H' 'U' 'F' | u8 版本 | u8 标志 | u16 保留 | u64 原始字节数
+// 带 PHUF_FLAG_PIXELS 时其后追加：u32 宽 | u32 高 | u16 位深
+// 载荷：HuffmanEncoder::encodeBytes 写出的块（码长表 + 打包位流）；
+// 带 PHUF_FLAG_LZ77 时为 <字面量/长度码长表><距离码长表><u64 位数><打包位流>
+// 带 PHUF_FLAG_TOKENS 时为 <u32 词表大小><词表：u16 长度 + UTF-16 码元><码长表><u64 符号数><u64 位数><打包位流>
+// 带 PHUF_FLAG_CONTEXT 时为 <u64 符号数><块...>（见 ContextCodec.h）
+// 带 PHUF_FLAG_MULTI 时字节/像素载荷换成分块多码表流（见 MultiTableCodec.h），加 PHUF_FLAG_TEXT 则符号为 UTF-16 码元
+// 旧格式按字符存 '0'/'1'，每个编码位占一个字节，再经过宽字符串中转，内存放大数十倍；
+// 这里全程按字节统计、建树、打包位流，不再生成任何中间字符串。
+
+constexpr uint8_t kPhufVersion = 1;
+
+enum PhufFlags : uint8_t {
+    PHUF_MODE_BYTES = 0,         // 整体按字节做一张哈夫曼表
+    PHUF_FLAG_PIXELS = 1 << 0,   // 载荷是按行排列的像素，头部带图像尺寸
+    PHUF_FLAG_PREDICT = 1 << 1,  // 像素先经过逐行预测滤波（ImageFilter.h），解码后需反滤波
+    PHUF_FLAG_RLE = 1 << 2,      // 载荷字母表含游程符号（见 HuffmanCodec.h 的游程长度码）
+    PHUF_FLAG_LZ77 = 1 << 3,     // 载荷为 LZ77 字面量/长度/距离序列（见 Lz77.h），不与其他标志组合
+    PHUF_FLAG_TOKENS = 1 << 4,   // 载荷为词级字母表编码的 UTF-8 文本（见 TextTokenizer.h），不与其他标志组合
+    PHUF_FLAG_CONTEXT = 1 << 5,  // 载荷为一阶上下文码表编码的 UTF-8 文本（见 ContextCodec.h），不与其他标志组合
+    PHUF_FLAG_MULTI = 1 << 6,    // 分块多码表，每 50 个符号选一张码表（见 MultiTableCodec.h），不与 PHUF_FLAG_RLE 组合
+    PHUF_FLAG_TEXT = 1 << 7,     // 与 PHUF_FLAG_MULTI 组合：载荷为 UTF-16 码元，原始字节数为 UTF-8 长度
+};
+
+// 词级字母表：出现至少 kMinTokenCount 次的多字符词进入词表，其余按单字符编码
+constexpr uint32_t kMinTokenCount = 2;
+constexpr uint32_t kMaxVocabulary = 0x10000;
+
+// 像素模式的图像参数；像素自上而下逐行紧密排列，每像素 bitsPerPixel/8 字节
+struct PhufImageInfo {
+    int width = 0;
+    int height = 0;
+    int bitsPerPixel = 0;
+};
+
+class PhufCodec {
+public:
+    static bool isPhuf(const uint8_t* data, size_t size);
+
+    // 进度与取消（见 JobProgress.h）：转给内部各编码/解码上下文，LZ77 与词级模式在本类里按块检查；nullptr 关闭
+    void setProgress(JobProgress* progress) {
+        m_progress = progress;
+        m_encoder.setProgress(progress);
+        m_decoder.setProgress(progress);
+        m_matcher.setProgress(progress);
+        m_context.setProgress(progress);
+        m_multi.setProgress(progress);
+    }
+
+    // 编码结果写入 out（会先清空）；flags 可选 PHUF_FLAG_RLE 或 PHUF_FLAG_MULTI
+    bool encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out, uint8_t flags = PHUF_MODE_BYTES);
+    // 像素编码；flags 可选 PHUF_FLAG_PREDICT（逐行选择左/上/Paeth 预测，只编码残差）与 PHUF_FLAG_RLE / PHUF_FLAG_MULTI
+    bool encodePixels(const uint8_t* pixels, const PhufImageInfo& info, uint8_t flags, std::vector<uint8_t>& out);
+    // LZ77 + 哈夫曼编码，level 取 kLz77MinLevel..kLz77MaxLevel
+    bool encodeLz77(const uint8_t* data, size_t size, int level, std::vector<uint8_t>& out);
+    // 词级哈夫曼编码 UTF-8 文本：字母表 = UTF-16 码元 + 高频词；BMP 以外的字符返回 false
+    bool encodeTokens(const std::string& utf8, std::vector<uint8_t>& out);
+    // 一阶上下文哈夫曼编码 UTF-8 文本；BMP 以外的字符返回 false
+    bool encodeContext(const std::string& utf8, std::vector<uint8_t>& out);
+    // 分块多码表编码 UTF-8 文本（按 UTF-16 码元）；BMP 以外的字符返回 false
+    bool encodeTextMulti(const std::string& utf8, std::vector<uint8_t>& out);
+    // 解码结果写入 out（会先清空）；格式错误或数据损坏返回 false
+    // 像素模式下 out 为还原后的像素，info 非空时写入图像参数
+    bool decode(const uint8_t* data, size_t size, std::vector<uint8_t>& out, PhufImageInfo* info = nullptr);
+
+private:
+    // 按标志写出 / 读取字节或像素载荷（单码表、游程或分块多码表）
+    bool encodePayload(const uint8_t* data, size_t size, uint8_t flags, std::vector<uint8_t>& out);
+    bool decodePayload(const uint8_t*& p, const uint8_t* end, uint8_t flags, std::vector<uint8_t>& out);
+    bool decodeLz77(const uint8_t*& p, const uint8_t* end, uint64_t original, std::vector<uint8_t>& out);
+    bool decodeTokens(const uint8_t*& p, const uint8_t* end, uint64_t original, std::vector<uint8_t>& out);
+
+    HuffmanEncoder m_encoder;
+    HuffmanDecoder m_decoder;
+    std::vector<uint8_t> m_filtered;
+    // LZ77 模式的距离表与匹配器
+    HuffmanEncoder m_distEncoder;
+    HuffmanDecoder m_distDecoder;
+    Lz77Matcher m_matcher;
+    std::vector<Lz77Token> m_tokens;
+    // 词级模式：词频表以 m_wtext 内的视图为键，词表解码后按 id 存放
+    std::wstring m_wtext;
+    std::vector<TextSpan> m_spans;
+    std::unordered_map<std::wstring_view, uint32_t> m_tokenCounts;
+    std::vector<std::wstring_view> m_vocab;
+    std::vector<std::wstring> m_vocabText;
+    ContextTextCodec m_context;
+    MultiTableCodec m_multi;
+    JobProgress* m_progress = nullptr;
+};
@@ -0,0 +1,50 @@
+#ifndef TEXT_TOKENIZER_H
+#define TEXT_TOKENIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 文本切词（与 project2 词频统计的 (\p{Han}+)|(\w+) 规则对应）：
+//   连续的字母/数字/下划线 -> 一个词；连续空白 -> 一个词；
+//   汉字按单字切分（同 fallbackCharSplit，后端不依赖外部分词器）；其余标点逐字符。
+// 切分结果首尾相接覆盖全文，按顺序拼接即可无损还原。
+
+struct TextSpan {
+    uint32_t start = 0;
+    uint32_t length = 0;
+};
+
+inline bool isHanChar(wchar_t c) {
+    return (c >= 0x4E00 && c <= 0x9FFF) || (c >= 0x3400 && c <= 0x4DBF) || (c >= 0xF900 && c <= 0xFAFF);
+}
+
+inline bool isWordChar(wchar_t c) {
+    if ((c >= L'0' && c <= L'9') || (c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') || c == L'_') return true;
+    // 拉丁扩展、希腊、西里尔字母（跳过 × ÷）
+    return (c >= 0x00C0 && c <= 0x024F && c != 0x00D7 && c != 0x00F7) || (c >= 0x0370 && c <= 0x04FF);
+}
+
+inline bool isSpaceChar(wchar_t c) {
+    return c == L' ' || c == L'\t' || c == L'\r' || c == L'\n' || c == 0x3000;
+}
+
+inline void tokenizeText(const wchar_t* text, size_t len, std::vector<TextSpan>& out) {
+    out.clear();
+    size_t i = 0;
+    while (i < len) {
+        size_t j = i + 1;
+        if (isWordChar(text[i])) {
+            while (j < len && isWordChar(text[j])) ++j;
+        } else if (isSpaceChar(text[i])) {
+            while (j < len && isSpaceChar(text[j])) ++j;
+        }
+        TextSpan s;
+        s.start = (uint32_t)i;
+        s.length = (uint32_t)(j - i);
+        out.push_back(s);
+        i = j;
+    }
+}
+
+#endif // TEXT_TOKENIZER_H
@@ -2,43 +2,111 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <chrono>
 #include <functional>
 #include <unordered_map>  // 添加这个头文件
 #include "EncodingUtils.h"
+#include "JobProgress.h"
 
 // 外部友好薄封装（UTF-8 / Qt 适配）
+// 耗时的函数都接受可选的 JobProgress*（见 JobProgress.h）：调用方可从其它线程读取阶段与进度，
+// 或请求取消；被取消的调用按失败返回（空结果 / false）。
 namespace backend_api {
 
+// 编码模式
+enum class CodecMode {
+    Huffman = 0,    // 逐符号哈夫曼（默认）
+    RunLength = 1,  // 游程 + 哈夫曼：连续重复的符号以 DEFLATE 式长度码混入字母表，适合大片纯色/重复内容
+    Token = 2,      // 词级字母表：高频词整体作为一个符号，罕见词按字符回退（仅文本）
+    Context = 3,    // 一阶上下文：按前一个字符选择码表（聚类为至多 8 张），适合中英文自然语言（仅文本）
+    MultiTable = 4, // 分块多码表：每 50 个符号挑选最省的一张码表，适合前后统计差异大的输入；各块可并行解码
+};
+
+// 哈夫曼建树过程，供可视化直接使用（不必在界面层重新统计、另建一棵树）
+// 节点 0..leaves.size()-1 为叶子（按频次、码元升序）；第 i 次合并产生节点 leaves.size()+i。
+// 叶子深度即实际码长，但码字按范式规则分配，与 left/right 的先后无关，实际码字见 Leaf::code。
+struct HuffmanBuildTrace {
+    struct Leaf {
+        ::std::string symbol;  // UTF-8
+        uint64_t count;
+        ::std::string code;    // 写入文件的码字，'0'/'1' 串
+    };
+    struct Merge {
+        int left;
+        int right;
+        uint64_t weight;
+    };
+    ::std::vector<Leaf> leaves;
+    ::std::vector<Merge> merges;
+};
+
 // 将 UTF-8 文本编码为一个合并字符串：<code_table>|<bits>
 // code_table 与 bits 均以宽字符串序列化后转换为 UTF-8 返回。
-::std::string encodeTextUtf8(const ::std::string &utf8_text);
+// RunLength 模式下类型标记为 TEXTRLE，只能由 decodeTextUtf8 解码；
+// Token / Context / MultiTable 模式输出 .phuf 二进制容器（含 '\0' 等任意字节）。
+// trace 非空且为 Huffman 模式时同时写出本次编码的建树过程，其它模式下置空。
+::std::string encodeTextUtf8(const ::std::string &utf8_text, CodecMode mode = CodecMode::Huffman,
+                             HuffmanBuildTrace *trace = nullptr, JobProgress *progress = nullptr);
 
 // 从 encodeTextUtf8 返回的字符串解码并返回原始 UTF-8 文本（若失败返回空字符串）
-::std::string decodeTextUtf8(const ::std::string &encoded_combined);
+// 也接受 .phuf 容器（Token / Context / MultiTable 模式、encodeTextFile 的 LZ77 等级）。
+::std::string decodeTextUtf8(const ::std::string &encoded_combined, JobProgress *progress = nullptr);
 
-// 将图片字节数据编码为一个合并字符串：<code_table>|<bits>
-// code_table 与 bits 均以宽字符串序列化后转换为 UTF-8 返回。
-::std::string encodeImage(const ::std::vector<uint8_t> &image_data);
+// 将图片字节数据编码为 .phuf 二进制容器（见 PhufFormat.h），以 std::string 承载原始字节。
+// 结果含 '\0' 等任意字节，写文件时请按二进制写入。
+::std::string encodeImage(const ::std::vector<uint8_t> &image_data, CodecMode mode = CodecMode::Huffman,
+                          JobProgress *progress = nullptr);
+
+// 从 encodeImage 返回的数据解码并返回原始图片数据（若失败返回空向量）
+// 同时兼容旧版 <code_table>|<bits> 文本格式。
+::std::vector<uint8_t> decodeImage(const ::std::string &encoded_combined, JobProgress *progress = nullptr);
 
-// 从 encodeImage 返回的字符串解码并返回原始图片数据（若失败返回空向量）
-::std::vector<uint8_t> decodeImage(const ::std::string &encoded_combined);
+// 将逐行排列的像素（每像素 bits_per_pixel/8 字节，自上而下）编码为 .phuf。
+// predict 为 true 时先做逐行预测滤波（左/上/Paeth），滤波类型随数据记录在 .phuf 中。
+::std::string encodeImagePixels(const ::std::vector<uint8_t> &pixels, int width, int height,
+                                int bits_per_pixel, bool predict = true,
+                                CodecMode mode = CodecMode::Huffman, JobProgress *progress = nullptr);
+
+// 解码 encodeImagePixels 的结果并返回像素，同时写出图像尺寸与位深（若失败返回空向量）
+::std::vector<uint8_t> decodeImagePixels(const ::std::string &encoded, int &width, int &height,
+                                         int &bits_per_pixel, JobProgress *progress = nullptr);
 
 // 直接从文件编码文本并保存为.huf文件
-bool encodeTextFile(const ::std::string &input_file_path, const ::std::string &output_huf_path);
+// level 为 0 时输出 encodeTextUtf8 的哈夫曼格式；1..9 时先做 LZ77 匹配（见 Lz77.h），
+// 输出 .phuf 二进制容器，等级越高窗口越大、搜索越充分，压缩率更高但更慢
+bool encodeTextFile(const ::std::string &input_file_path, const ::std::string &output_huf_path, int level = 0,
+                    JobProgress *progress = nullptr);
 
-// 直接从.huf文件解码并保存为文本文件
-bool decodeTextFile(const ::std::string &input_huf_path, const ::std::string &output_file_path);
+// 直接从.huf文件解码并保存为文本文件（自动识别 encodeTextFile 各等级的输出）
+bool decodeTextFile(const ::std::string &input_huf_path, const ::std::string &output_file_path,
+                    JobProgress *progress = nullptr);
 
 // 直接从文件编码图片并保存为.huf文件
-bool encodeImageFile(const ::std::string &input_image_path, const ::std::string &output_huf_path);
+bool encodeImageFile(const ::std::string &input_image_path, const ::std::string &output_huf_path,
+                     JobProgress *progress = nullptr);
 
 // 直接从.huf文件解码并保存为图片文件
-bool decodeImageFile(const ::std::string &input_huf_path, const ::std::string &output_image_path);
+bool decodeImageFile(const ::std::string &input_huf_path, const ::std::string &output_image_path,
+                     JobProgress *progress = nullptr);
 
 // 流式读取文本文件并统计字符频率（用于进度显示等）
 void streamTextFile(const ::std::string &file_path, 
                    const ::std::function<void(const ::std::unordered_map<char32_t, size_t> &)> &callback, 
-                   size_t batch_size = 1024);
+                   size_t batch_size = 1024, JobProgress *progress = nullptr);
+
+// 增量快照：只回调自上次回调以来计数变化过的字符及其当前累计次数
+struct SymbolCount {
+    char32_t symbol;
+    size_t count;
+};
+
+// 与 streamTextFile 统计口径相同，但按时间间隔（而非字符数）回调，每次只给出变化的部分。
+// delta 是内部复用的缓冲，只在回调期间有效；扫描结束时最后回调一次剩余的变化。
+// 回调开销与两次回调之间出现过的字符种类数成正比，与总词表大小无关。
+void streamTextFileDelta(const ::std::string &file_path,
+                         const ::std::function<void(const ::std::vector<SymbolCount> &delta)> &callback,
+                         ::std::chrono::milliseconds interval = ::std::chrono::milliseconds(100),
+                         JobProgress *progress = nullptr);
 
 #ifdef QT_CORE_LIB
 #include <QString>
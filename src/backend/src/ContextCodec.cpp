@@ -0,0 +1,239 @@
+#include "ContextCodec.h"
+#include <algorithm>
+#include <cmath>
+
+bool ContextTextCodec::encode(const std::wstring& text, std::vector<uint8_t>& out) {
+    appendLE(out, text.size(), 8);
+    if (!progressBegin(m_progress, JobProgress::Encoding, text.size())) return false;
+    for (size_t pos = 0; pos < text.size(); pos += kContextBlockSymbols) {
+        size_t count = std::min<size_t>(kContextBlockSymbols, text.size() - pos);
+        if (!progressAt(m_progress, pos)) return false;
+        if (!encodeBlock(text.data() + pos, count, pos, out)) return false;
+    }
+    return progressAt(m_progress, text.size());
+}
+
+bool ContextTextCodec::decode(const uint8_t*& p, const uint8_t* end, std::wstring& text) {
+    text.clear();
+    uint64_t total = 0;
+    if (!readLE(p, end, total, 8)) return false;
+    if (!progressBegin(m_progress, JobProgress::Decoding, total)) return false;
+    while (text.size() < total) {
+        if (!decodeBlock(p, end, text)) return false;
+        if (text.size() > total) return false;
+    }
+    return true;
+}
+
+// 按上下文的频率分布聚类：出现最多的 K-1 个上下文各作为一个类的种子，其余先归入 0 类，
+// 然后迭代几轮"按当前各类分布计算代价、把每个上下文改派到代价最小的类"（类似 k-means）
+void ContextTextCodec::clusterContexts(unsigned tableCount) {
+    const size_t contexts = m_ctxTotal.size();
+    const size_t n = m_symbols.size();
+    m_ctxTable.assign(contexts, 0);
+    if (tableCount <= 1) return;
+
+    std::vector<uint32_t> order(contexts);
+    for (size_t c = 0; c < contexts; ++c) order[c] = (uint32_t)c;
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        if (m_ctxTotal[a] != m_ctxTotal[b]) return m_ctxTotal[a] > m_ctxTotal[b];
+        return a < b;
+    });
+    for (unsigned k = 1; k < tableCount && k - 1 < contexts; ++k) m_ctxTable[order[k - 1]] = (uint8_t)k;
+
+    std::vector<double> hist(tableCount * n);
+    std::vector<double> total(tableCount);
+    std::vector<float> cost(tableCount * n);
+    for (int round = 0; round < 3; ++round) {
+        std::fill(hist.begin(), hist.end(), 0.0);
+        std::fill(total.begin(), total.end(), 0.0);
+        for (size_t c = 0; c < contexts; ++c) {
+            double* h = &hist[m_ctxTable[c] * n];
+            for (uint32_t i = m_ctxBegin[c]; i < m_ctxBegin[c + 1]; ++i) h[m_pairSym[i]] += m_pairCount[i];
+            total[m_ctxTable[c]] += (double)m_ctxTotal[c];
+        }
+        // 估计码长 -log2(p)，加 0.5 平滑，未出现过的符号代价高但有限
+        for (unsigned k = 0; k < tableCount; ++k) {
+            double denom = std::log2(total[k] + 0.5 * n);
+            for (size_t s = 0; s < n; ++s) cost[k * n + s] = (float)(denom - std::log2(hist[k * n + s] + 0.5));
+        }
+        bool changed = false;
+        for (size_t c = 0; c < contexts; ++c) {
+            unsigned best = m_ctxTable[c];
+            double bestCost = 0;
+            for (unsigned k = 0; k < tableCount; ++k) {
+                double sum = 0;
+                const float* ck = &cost[k * n];
+                for (uint32_t i = m_ctxBegin[c]; i < m_ctxBegin[c + 1]; ++i) sum += ck[m_pairSym[i]] * m_pairCount[i];
+                if (k == 0 || sum < bestCost) {
+                    bestCost = sum;
+                    best = k;
+                }
+            }
+            if (best != m_ctxTable[c]) {
+                m_ctxTable[c] = (uint8_t)best;
+                changed = true;
+            }
+        }
+        if (!changed) break;
+    }
+
+    // 去掉空类，编号压紧
+    std::vector<int> remap(tableCount, -1);
+    int next = 0;
+    for (size_t c = 0; c < contexts; ++c) {
+        if (remap[m_ctxTable[c]] < 0) remap[m_ctxTable[c]] = next++;
+        m_ctxTable[c] = (uint8_t)remap[m_ctxTable[c]];
+    }
+}
+
+bool ContextTextCodec::encodeBlock(const wchar_t* text, size_t count, size_t offset, std::vector<uint8_t>& out) {
+    // 块内符号表
+    m_localIndex.assign(HuffmanEncoder::kTextAlphabet, -1);
+    m_symbols.clear();
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t u = (uint32_t)text[i];
+        if (u >= HuffmanEncoder::kTextAlphabet) return false;
+        if (m_localIndex[u] < 0) {
+            m_localIndex[u] = 0;
+            m_symbols.push_back(u);
+        }
+    }
+    std::sort(m_symbols.begin(), m_symbols.end());
+    for (size_t i = 0; i < m_symbols.size(); ++i) m_localIndex[m_symbols[i]] = (int32_t)i;
+    const uint32_t n = (uint32_t)m_symbols.size();
+    const uint32_t start = n;  // 块首符号的上下文
+
+    m_local.resize(count);
+    for (size_t i = 0; i < count; ++i) m_local[i] = (uint32_t)m_localIndex[(uint32_t)text[i]];
+
+    // (上下文, 符号) 对计数：排序后同一上下文的统计连续存放
+    m_pairs.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t ctx = i == 0 ? start : m_local[i - 1];
+        m_pairs[i] = ctx << 32 | m_local[i];
+    }
+    std::sort(m_pairs.begin(), m_pairs.end());
+    m_pairSym.clear();
+    m_pairCount.clear();
+    m_ctxBegin.assign(n + 2, 0);
+    m_ctxTotal.assign(n + 1, 0);
+    for (size_t i = 0; i < count;) {
+        size_t j = i + 1;
+        while (j < count && m_pairs[j] == m_pairs[i]) ++j;
+        uint32_t ctx = (uint32_t)(m_pairs[i] >> 32);
+        m_pairSym.push_back((uint32_t)m_pairs[i]);
+        m_pairCount.push_back((uint32_t)(j - i));
+        m_ctxBegin[ctx + 1]++;
+        m_ctxTotal[ctx] += j - i;
+        i = j;
+    }
+    for (uint32_t c = 0; c <= n; ++c) m_ctxBegin[c + 1] += m_ctxBegin[c];
+
+    unsigned tableCount = (unsigned)std::min<size_t>(kMaxContextTables, 1 + count / kSymbolsPerContextTable);
+    clusterContexts(tableCount);
+    tableCount = 0;
+    for (uint8_t t : m_ctxTable) tableCount = std::max<unsigned>(tableCount, t + 1u);
+
+    if (m_encoders.size() < tableCount) m_encoders.resize(tableCount);
+    for (unsigned k = 0; k < tableCount; ++k) m_encoders[k].reset(n);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t ctx = i == 0 ? start : m_local[i - 1];
+        m_encoders[m_ctxTable[ctx]].count(m_local[i]);
+    }
+
+    // 默认码表取覆盖上下文最多的一类，映射里只写例外
+    std::vector<uint32_t> tableUse(tableCount, 0);
+    for (size_t c = 0; c < m_ctxTable.size(); ++c) {
+        if (m_ctxTotal[c] > 0) tableUse[m_ctxTable[c]]++;
+    }
+    uint8_t defaultTable = (uint8_t)(std::max_element(tableUse.begin(), tableUse.end()) - tableUse.begin());
+
+    appendVarint(out, count);
+    appendVarint(out, n);
+    uint32_t prev = 0;
+    for (uint32_t sym : m_symbols) {
+        appendVarint(out, sym - prev);
+        prev = sym;
+    }
+    appendVarint(out, tableCount);
+    out.push_back(defaultTable);
+    uint64_t exceptions = 0;
+    for (size_t c = 0; c < m_ctxTable.size(); ++c) {
+        if (m_ctxTotal[c] > 0 && m_ctxTable[c] != defaultTable) ++exceptions;
+    }
+    appendVarint(out, exceptions);
+    uint32_t prevCtx = 0;
+    for (uint32_t c = 0; c < m_ctxTable.size(); ++c) {
+        if (m_ctxTotal[c] == 0 || m_ctxTable[c] == defaultTable) continue;
+        appendVarint(out, c - prevCtx);
+        out.push_back(m_ctxTable[c]);
+        prevCtx = c;
+    }
+
+    uint64_t bits = 0;
+    for (unsigned k = 0; k < tableCount; ++k) {
+        if (!m_encoders[k].usedSymbols().empty() && !m_encoders[k].buildCodes()) return false;
+        m_encoders[k].writeLengths(out);
+        bits += m_encoders[k].encodedBits();
+    }
+    appendLE(out, bits, 8);
+    BitWriter bw(out);
+    for (size_t i = 0; i < count; ++i) {
+        if ((i & (kProgressBlock - 1)) == kProgressBlock - 1 && !progressAt(m_progress, offset + i)) return false;
+        uint32_t ctx = i == 0 ? start : m_local[i - 1];
+        m_encoders[m_ctxTable[ctx]].put(m_local[i], bw);
+    }
+    bw.flush();
+    return true;
+}
+
+bool ContextTextCodec::decodeBlock(const uint8_t*& p, const uint8_t* end, std::wstring& text) {
+    uint64_t count = 0, n = 0, tableCount = 0, exceptions = 0, v = 0;
+    if (!readVarint(p, end, count) || count == 0 || count > kContextBlockSymbols) return false;
+    if (!readVarint(p, end, n) || n == 0 || n > HuffmanEncoder::kTextAlphabet) return false;
+    m_symbols.resize((size_t)n);
+    uint64_t sym = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+        if (!readVarint(p, end, v)) return false;
+        sym += v;
+        if (sym >= HuffmanEncoder::kTextAlphabet) return false;
+        m_symbols[(size_t)i] = (uint32_t)sym;
+    }
+
+    if (!readVarint(p, end, tableCount) || tableCount == 0 || tableCount > kMaxContextTables) return false;
+    if (p >= end || *p >= tableCount) return false;
+    m_ctxTable.assign((size_t)n + 1, *p++);
+    if (!readVarint(p, end, exceptions) || exceptions > n + 1) return false;
+    uint64_t ctx = 0;
+    for (uint64_t i = 0; i < exceptions; ++i) {
+        if (!readVarint(p, end, v)) return false;
+        ctx += v;
+        if (ctx > n || p >= end || *p >= tableCount) return false;
+        m_ctxTable[(size_t)ctx] = *p++;
+    }
+
+    if (m_decoders.size() < tableCount) m_decoders.resize((size_t)tableCount);
+    for (uint64_t k = 0; k < tableCount; ++k) {
+        if (!m_decoders[(size_t)k].readLengths(p, end, (uint32_t)n)) return false;
+    }
+    uint64_t bits = 0;
+    if (!readLE(p, end, bits, 8)) return false;
+    uint64_t bytes = (bits + 7) / 8;
+    if ((uint64_t)(end - p) < bytes || count > bits) return false;
+
+    // 快速路径：上下文 -> 码表编号是一次数组查找，随后走该码表的快速查找表
+    BitReader br(p, bits);
+    uint32_t prev = (uint32_t)n;
+    uint32_t local = 0;
+    text.reserve(text.size() + (size_t)count);
+    for (uint64_t i = 0; i < count; ++i) {
+        if ((i & (kProgressBlock - 1)) == kProgressBlock - 1 && !progressAt(m_progress, text.size())) return false;
+        if (!m_decoders[m_ctxTable[prev]].decodeSymbol(br, local)) return false;
+        text.push_back((wchar_t)m_symbols[local]);
+        prev = local;
+    }
+    if (br.remaining() != 0) return false;
+    p += bytes;
+    return true;
+}
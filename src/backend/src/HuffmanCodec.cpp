@@ -0,0 +1,628 @@
+#include "HuffmanCodec.h"
+#include <algorithm>
+#include <charconv>
+#include <windows.h>
+
+// ==================== 位流 ====================
+
+void BitWriter::write(uint32_t bits, unsigned len) {
+    if (len == 0) return;
+    // m_acc 中最多残留 7 位，再放入 32 位不会溢出
+    m_acc = (m_acc << len) | (len == 32 ? bits : (bits & ((1u << len) - 1)));
+    m_accBits += len;
+    m_bitCount += len;
+    while (m_accBits >= 8) {
+        m_accBits -= 8;
+        m_out.push_back((uint8_t)(m_acc >> m_accBits));
+    }
+    m_acc &= (1ull << m_accBits) - 1;
+}
+
+void BitWriter::flush() {
+    if (m_accBits > 0) {
+        m_out.push_back((uint8_t)(m_acc << (8 - m_accBits)));
+        m_acc = 0;
+        m_accBits = 0;
+    }
+}
+
+uint32_t BitReader::peek(unsigned n) const {
+    if (n == 0) return 0;
+    uint64_t byte = m_pos >> 3;
+    unsigned off = (unsigned)(m_pos & 7);
+    // 取 5 个字节（40 位）的窗口，足够覆盖 off + 32 位
+    uint64_t window = 0;
+    for (int i = 0; i < 5; ++i) {
+        window <<= 8;
+        if (byte + i < m_bytes) window |= m_data[byte + i];
+    }
+    return (uint32_t)((window >> (40 - off - n)) & ((1ull << n) - 1));
+}
+
+// ==================== 游程长度码 ====================
+
+static const uint16_t kRunBase[kRunCodeCount] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t kRunExtra[kRunCodeCount] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+unsigned runLengthCode(uint32_t len) {
+    return (unsigned)(std::upper_bound(kRunBase, kRunBase + kRunCodeCount, len) - kRunBase - 1);
+}
+
+uint32_t runLengthBase(unsigned code) { return kRunBase[code]; }
+
+unsigned runLengthExtra(unsigned code) { return kRunExtra[code]; }
+
+// 把序列切成字面量与游程：每段相同符号先输出一次字面量，
+// 其后的重复按 kMinRun..kMaxRun 切成游程，不足 kMinRun 的余数仍输出为字面量。
+// 每处理约 kProgressBlock 个元素汇报一次进度，被取消时返回 false
+template <typename T, typename LiteralFn, typename RunFn>
+static bool scanRuns(const T* data, size_t size, JobProgress* progress, LiteralFn literal, RunFn run) {
+    size_t i = 0;
+    size_t nextReport = kProgressBlock;
+    while (i < size) {
+        if (i >= nextReport) {
+            if (!progressAt(progress, i)) return false;
+            nextReport = i + kProgressBlock;
+        }
+        T v = data[i];
+        size_t j = i + 1;
+        while (j < size && data[j] == v) ++j;
+        literal(v);
+        size_t rep = j - i - 1;
+        while (rep >= kMinRun) {
+            uint32_t len = (uint32_t)std::min<size_t>(rep, kMaxRun);
+            run(len);
+            rep -= len;
+        }
+        while (rep-- > 0) literal(v);
+        i = j;
+    }
+    return progressAt(progress, size);
+}
+
+// ==================== 编码上下文 ====================
+
+void HuffmanEncoder::reset(uint32_t alphabetSize) {
+    if (m_freq.size() < alphabetSize) {
+        m_freq.resize(alphabetSize, 0);
+        m_codes.resize(alphabetSize);
+    }
+    // 只清理上一轮用到的符号，大字母表（文本 64K）也不必整表清零
+    for (uint32_t sym : m_used) {
+        m_freq[sym] = 0;
+        m_codes[sym] = HuffmanCode();
+    }
+    m_used.clear();
+    m_alphabet = alphabetSize;
+}
+
+bool HuffmanEncoder::buildCodes(unsigned maxLen) {
+    if (m_used.empty()) return false;
+    if (maxLen == 0 || maxLen > kMaxCodeLen) maxLen = kMaxCodeLen;
+
+    // 按 (频率, 符号) 升序排列叶子
+    m_order.assign(m_used.begin(), m_used.end());
+    std::sort(m_order.begin(), m_order.end(), [this](uint32_t a, uint32_t b) {
+        if (m_freq[a] != m_freq[b]) return m_freq[a] < m_freq[b];
+        return a < b;
+    });
+    // assignCanonical 会按码长重排 m_order，建树时的叶子顺序另存一份
+    m_mergeLeaves.assign(m_order.begin(), m_order.end());
+    m_merges.clear();
+
+    if (m_order.size() == 1) {
+        // 只有一个符号时仍分配 1 位码字，否则位流为空无法还原长度
+        m_codes[m_order[0]].len = 1;
+    } else {
+        const size_t k = m_order.size();
+        m_nodeFreq.resize(2 * k - 1);
+        unsigned shift = 0;
+        for (;; ++shift) {
+            // 频率右移后保持原有顺序，叶子无需重新排序
+            for (size_t i = 0; i < m_order.size(); ++i) {
+                uint64_t f = m_freq[m_order[i]];
+                m_nodeFreq[i] = shift == 0 ? f : 1 + (f >> shift);
+            }
+            computeLengths();
+            unsigned longest = 0;
+            for (uint32_t sym : m_order) longest = std::max<unsigned>(longest, m_codes[sym].len);
+            if (longest <= maxLen) break;
+        }
+        // 限长时树是按缩小后的频率建的；合并记录的权重改回原始频率之和，与字符计数一致
+        if (shift > 0) {
+            for (size_t i = 0; i < k; ++i) m_nodeFreq[i] = m_freq[m_order[i]];
+            for (size_t j = 0; j < m_merges.size(); ++j) {
+                Merge& m = m_merges[j];
+                m.weight = m_nodeFreq[m.left] + m_nodeFreq[m.right];
+                m_nodeFreq[k + j] = m.weight;
+            }
+        }
+    }
+    assignCanonical();
+    return true;
+}
+
+// 两队列法建树：叶子已按权重排好，合并产生的内部节点权重单调不减，
+// 每次从两个队首取较小者即可，整体 O(n)（不含排序），不需要反复 sort 整个节点池
+void HuffmanEncoder::computeLengths() {
+    const size_t k = m_order.size();
+    const size_t total = 2 * k - 1;
+    m_nodeFreq.resize(total);
+    m_nodeParent.resize(total);
+    m_nodeDepth.resize(total);
+    m_merges.resize(k - 1);
+
+    size_t leaf = 0, inner = k;
+    auto pickMin = [&](size_t next) -> size_t {
+        // 同权重时叶子优先（与 HuffmanTree 的排序规则一致）
+        if (leaf < k && (inner >= next || m_nodeFreq[leaf] <= m_nodeFreq[inner])) return leaf++;
+        return inner++;
+    };
+    for (size_t next = k; next < total; ++next) {
+        size_t a = pickMin(next);
+        size_t b = pickMin(next);
+        m_nodeFreq[next] = m_nodeFreq[a] + m_nodeFreq[b];
+        m_nodeParent[a] = (uint32_t)next;
+        m_nodeParent[b] = (uint32_t)next;
+        m_merges[next - k] = Merge{(uint32_t)a, (uint32_t)b, m_nodeFreq[next]};
+    }
+
+    // 父节点下标总大于子节点，倒序一遍即可得到深度
+    m_nodeDepth[total - 1] = 0;
+    for (size_t i = total - 1; i-- > 0;) {
+        m_nodeDepth[i] = m_nodeDepth[m_nodeParent[i]] + 1;
+    }
+    for (size_t i = 0; i < k; ++i) {
+        uint32_t depth = m_nodeDepth[i];
+        m_codes[m_order[i]].len = (uint8_t)std::min<uint32_t>(depth, 255);
+    }
+}
+
+void HuffmanEncoder::assignCanonical() {
+    std::sort(m_order.begin(), m_order.end(), [this](uint32_t a, uint32_t b) {
+        if (m_codes[a].len != m_codes[b].len) return m_codes[a].len < m_codes[b].len;
+        return a < b;
+    });
+    uint32_t code = 0;
+    unsigned prevLen = m_codes[m_order[0]].len;
+    for (uint32_t sym : m_order) {
+        unsigned len = m_codes[sym].len;
+        code <<= (len - prevLen);
+        m_codes[sym].bits = code;
+        ++code;
+        prevLen = len;
+    }
+    std::sort(m_used.begin(), m_used.end());
+}
+
+uint64_t HuffmanEncoder::encodedBits() const {
+    uint64_t bits = 0;
+    for (uint32_t sym : m_used) bits += m_freq[sym] * m_codes[sym].len;
+    return bits;
+}
+
+void HuffmanEncoder::writeLengths(std::vector<uint8_t>& out) const {
+    uint32_t sym = 0;
+    while (sym < m_alphabet) {
+        uint8_t len = m_freq[sym] ? m_codes[sym].len : 0;
+        if (len > 0) {
+            out.push_back(len);
+            ++sym;
+            continue;
+        }
+        uint32_t run = 0;
+        while (sym < m_alphabet && run < 256 && m_freq[sym] == 0) {
+            ++run;
+            ++sym;
+        }
+        out.push_back(0);
+        out.push_back((uint8_t)(run - 1));
+    }
+}
+
+bool HuffmanEncoder::encodeBytes(const uint8_t* data, size_t size, std::vector<uint8_t>& out, bool runLength) {
+    if (runLength) {
+        reset(256 + kRunCodeCount);
+        if (!progressBegin(m_progress, JobProgress::Analyzing, size)) return false;
+        if (!scanRuns(data, size, m_progress, [this](uint8_t v) { count(v); },
+                      [this](uint32_t len) { count(256 + runLengthCode(len)); })) return false;
+        if (size > 0 && !buildCodes()) return false;
+
+        writeLengths(out);
+        appendLE(out, size, 8);
+        // 位数含游程的 extra 位，写完位流后回填
+        size_t bitsPos = out.size();
+        appendLE(out, 0, 8);
+        BitWriter bw(out);
+        if (!progressBegin(m_progress, JobProgress::Encoding, size)) return false;
+        bool done = scanRuns(data, size, m_progress, [&](uint8_t v) { put(v, bw); },
+                             [&](uint32_t len) {
+                                 unsigned c = runLengthCode(len);
+                                 put(256 + c, bw);
+                                 bw.write(len - kRunBase[c], kRunExtra[c]);
+                             });
+        if (!done) return false;
+        bw.flush();
+        for (unsigned i = 0; i < 8; ++i) out[bitsPos + i] = (uint8_t)(bw.bitCount() >> (8 * i));
+        return true;
+    }
+
+    reset(256);
+    if (!progressBegin(m_progress, JobProgress::Analyzing, size)) return false;
+    for (size_t i = 0; i < size;) {
+        const size_t blockEnd = std::min(size, i + kProgressBlock);
+        for (; i < blockEnd; ++i) count(data[i]);
+        if (!progressAt(m_progress, i)) return false;
+    }
+    if (size > 0 && !buildCodes()) return false;
+
+    writeLengths(out);
+    uint64_t bits = encodedBits();
+    appendLE(out, size, 8);
+    appendLE(out, bits, 8);
+
+    out.reserve(out.size() + (size_t)((bits + 7) / 8));
+    BitWriter bw(out);
+    if (!progressBegin(m_progress, JobProgress::Encoding, size)) return false;
+    for (size_t i = 0; i < size;) {
+        const size_t blockEnd = std::min(size, i + kProgressBlock);
+        for (; i < blockEnd; ++i) put(data[i], bw);
+        if (!progressAt(m_progress, i)) return false;
+    }
+    bw.flush();
+    return true;
+}
+
+const std::string& HuffmanEncoder::encodeTextUtf8(const std::string& utf8, bool runLength) {
+    m_out.clear();
+
+    int wlen = 0;
+    if (!utf8.empty()) {
+        wlen = MultiByteToWideChar(CP_UTF8, 0, utf8.data(), (int)utf8.size(), NULL, 0);
+        if (wlen <= 0) return m_out;
+    }
+    m_wtext.resize(wlen);
+    if (wlen > 0) {
+        MultiByteToWideChar(CP_UTF8, 0, utf8.data(), (int)utf8.size(), &m_wtext[0], wlen);
+    }
+
+    if (runLength) {
+        reset(kTextAlphabet + kRunCodeCount);
+        for (wchar_t wc : m_wtext) {
+            if ((uint32_t)wc >= kTextAlphabet) return m_out;
+        }
+        if (!progressBegin(m_progress, JobProgress::Analyzing, m_wtext.size())) return m_out;
+        if (!scanRuns(m_wtext.data(), m_wtext.size(), m_progress, [this](wchar_t wc) { count((uint32_t)wc); },
+                      [this](uint32_t len) { count(kTextAlphabet + runLengthCode(len)); })) return m_out;
+    } else {
+        reset(kTextAlphabet);
+        if (!progressBegin(m_progress, JobProgress::Analyzing, m_wtext.size())) return m_out;
+        for (size_t i = 0; i < m_wtext.size();) {
+            const size_t blockEnd = std::min(m_wtext.size(), i + kProgressBlock);
+            for (; i < blockEnd; ++i) {
+                const uint32_t wc = (uint32_t)m_wtext[i];
+                if (wc >= kTextAlphabet) return m_out;
+                count(wc);
+            }
+            if (!progressAt(m_progress, i)) return m_out;
+        }
+    }
+
+    m_out.append(runLength ? "TEXTRLE|" : "TEXT|");
+    if (!m_used.empty()) {
+        buildCodes();
+        char num[16];
+        for (uint32_t sym : m_used) {
+            auto res = std::to_chars(num, num + sizeof(num), sym);
+            m_out.append(num, res.ptr);
+            m_out.push_back('|');
+            const HuffmanCode& c = m_codes[sym];
+            for (int b = c.len - 1; b >= 0; --b) m_out.push_back((c.bits >> b) & 1 ? '1' : '0');
+            m_out.push_back('|');
+        }
+    }
+    m_out.push_back('|');
+
+    if (runLength) {
+        auto putBits = [this](uint32_t bits, unsigned len) {
+            for (int b = (int)len - 1; b >= 0; --b) m_out.push_back((bits >> b) & 1 ? '1' : '0');
+        };
+        bool done = progressBegin(m_progress, JobProgress::Encoding, m_wtext.size()) &&
+                    scanRuns(m_wtext.data(), m_wtext.size(), m_progress,
+                             [&](wchar_t wc) {
+                                 const HuffmanCode& c = m_codes[(uint32_t)wc];
+                                 putBits(c.bits, c.len);
+                             },
+                             [&](uint32_t len) {
+                                 unsigned rc = runLengthCode(len);
+                                 const HuffmanCode& c = m_codes[kTextAlphabet + rc];
+                                 putBits(c.bits, c.len);
+                                 putBits(len - kRunBase[rc], kRunExtra[rc]);
+                             });
+        if (!done) m_out.clear();
+        return m_out;
+    }
+
+    // 位串总长可由频率直接算出，一次性扩容后顺序写入
+    size_t base = m_out.size();
+    m_out.resize(base + (size_t)encodedBits());
+    char* p = &m_out[base];
+    if (!progressBegin(m_progress, JobProgress::Encoding, m_wtext.size())) {
+        m_out.clear();
+        return m_out;
+    }
+    for (size_t i = 0; i < m_wtext.size();) {
+        const size_t blockEnd = std::min(m_wtext.size(), i + kProgressBlock);
+        for (; i < blockEnd; ++i) {
+            const HuffmanCode& c = m_codes[(uint32_t)m_wtext[i]];
+            for (int b = c.len - 1; b >= 0; --b) *p++ = (c.bits >> b) & 1 ? '1' : '0';
+        }
+        if (!progressAt(m_progress, i)) {
+            m_out.clear();
+            return m_out;
+        }
+    }
+    return m_out;
+}
+
+// ==================== 解码上下文 ====================
+
+void HuffmanDecoder::reset() {
+    m_child.assign(2, 0);
+    m_fast.clear();
+}
+
+bool HuffmanDecoder::addCode(uint32_t sym, uint32_t bits, unsigned len) {
+    if (len == 0 || len > HuffmanEncoder::kMaxCodeLen || sym > 0x7FFFFFFFu) return false;
+    if (m_child.empty()) m_child.assign(2, 0);
+
+    int32_t node = 0;
+    for (unsigned i = len; i-- > 1;) {
+        size_t slot = 2 * (size_t)node + ((bits >> i) & 1);
+        int32_t c = m_child[slot];
+        if (c < 0) return false;  // 已有码字是当前码字的前缀
+        if (c == 0) {
+            c = (int32_t)(m_child.size() / 2);
+            m_child[slot] = c;
+            m_child.push_back(0);
+            m_child.push_back(0);
+        }
+        node = c;
+    }
+    size_t slot = 2 * (size_t)node + (bits & 1);
+    if (m_child[slot] != 0) return false;
+    m_child[slot] = ~(int32_t)sym;
+    return true;
+}
+
+void HuffmanDecoder::finalize() {
+    m_fast.assign(1u << kFastBits, FastEntry());
+    for (uint32_t idx = 0; idx < (1u << kFastBits); ++idx) {
+        int32_t node = 0;
+        FastEntry e;
+        for (unsigned k = 1; k <= kFastBits; ++k) {
+            int32_t c = m_child[2 * (size_t)node + ((idx >> (kFastBits - k)) & 1)];
+            if (c == 0) break;
+            if (c < 0) {
+                e.target = c;
+                e.len = (uint8_t)k;
+                break;
+            }
+            node = c;
+            if (k == kFastBits) {
+                e.target = node;
+                e.len = (uint8_t)kFastBits;
+            }
+        }
+        m_fast[idx] = e;
+    }
+}
+
+bool HuffmanDecoder::readLengths(const uint8_t*& p, const uint8_t* end, uint32_t alphabetSize) {
+    reset();
+    m_lens.assign(alphabetSize, 0);
+    uint32_t sym = 0;
+    while (sym < alphabetSize) {
+        if (p >= end) return false;
+        uint8_t len = *p++;
+        if (len > 0) {
+            if (len > HuffmanEncoder::kMaxCodeLen) return false;
+            m_lens[sym++] = len;
+            continue;
+        }
+        if (p >= end) return false;
+        uint32_t run = (uint32_t)*p++ + 1;
+        if (run > alphabetSize - sym) return false;
+        sym += run;
+    }
+
+    // 范式码：同码长内按符号升序连续分配，与 HuffmanEncoder::assignCanonical 一致
+    uint32_t lenCount[HuffmanEncoder::kMaxCodeLen + 1] = {0};
+    for (uint8_t len : m_lens) lenCount[len]++;
+    lenCount[0] = 0;
+    uint64_t nextCode[HuffmanEncoder::kMaxCodeLen + 1] = {0};
+    uint64_t code = 0;
+    for (unsigned len = 1; len <= HuffmanEncoder::kMaxCodeLen; ++len) {
+        code = (code + lenCount[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+    bool any = false;
+    for (uint32_t s = 0; s < alphabetSize; ++s) {
+        unsigned len = m_lens[s];
+        if (len == 0) continue;
+        uint64_t c = nextCode[len]++;
+        if (c >= (1ull << len)) return false;  // 码长表超额，不是合法前缀码
+        if (!addCode(s, (uint32_t)c, len)) return false;
+        any = true;
+    }
+    if (any) finalize();
+    return true;
+}
+
+bool HuffmanDecoder::decodeBytes(const uint8_t*& p, const uint8_t* end, std::vector<uint8_t>& out, bool runLength) {
+    uint64_t size = 0, bits = 0;
+    if (!readLengths(p, end, runLength ? 256 + kRunCodeCount : 256)) return false;
+    if (!readLE(p, end, size, 8) || !readLE(p, end, bits, 8)) return false;
+    uint64_t bytes = (bits + 7) / 8;
+    if ((uint64_t)(end - p) < bytes) return false;
+    if (size == 0) return bits == 0;
+    // 头部的 size 不可信：每个符号至少 1 位，最多展开一个最长游程，超出即为损坏数据
+    uint64_t maxSize = runLength ? bits * kRunBase[kRunCodeCount - 1] : bits;
+    if (size > maxSize || size > (uint64_t)(SIZE_MAX - out.size())) return false;
+
+    BitReader br(p, bits);
+    size_t base = out.size();
+    out.resize(base + (size_t)size);
+    uint8_t* dst = out.data() + base;
+    uint32_t sym = 0;
+    if (!progressBegin(m_progress, JobProgress::Decoding, size)) return false;
+    uint64_t nextReport = kProgressBlock;
+    for (uint64_t i = 0; i < size;) {
+        if (i >= nextReport) {
+            if (!progressAt(m_progress, i)) return false;
+            nextReport = i + kProgressBlock;
+        }
+        if (!decodeSymbol(br, sym)) return false;
+        if (sym < 256) {
+            dst[i++] = (uint8_t)sym;
+            continue;
+        }
+        // 游程：重复前一个字节
+        unsigned code = sym - 256;
+        unsigned extra = kRunExtra[code];
+        if (i == 0 || br.remaining() < extra) return false;
+        uint64_t len = kRunBase[code] + br.read(extra);
+        if (len > size - i) return false;
+        std::fill(dst + i, dst + i + len, dst[i - 1]);
+        i += len;
+    }
+    if (br.remaining() != 0) return false;
+    p += bytes;
+    return true;
+}
+
+bool HuffmanDecoder::decodeSymbol(BitReader& br, uint32_t& sym) const {
+    uint64_t rem = br.remaining();
+    if (rem == 0 || m_fast.empty()) return false;
+
+    const FastEntry& e = m_fast[br.peek(kFastBits)];
+    if (e.len == 0 || e.len > rem) return false;
+    br.skip(e.len);
+    if (e.target < 0) {
+        sym = (uint32_t)~e.target;
+        return true;
+    }
+
+    // 长码字：从快速表停下的节点继续逐位走
+    int32_t node = e.target;
+    while (br.remaining() > 0) {
+        int32_t c = m_child[2 * (size_t)node + br.read(1)];
+        if (c == 0) return false;
+        if (c < 0) {
+            sym = (uint32_t)~c;
+            return true;
+        }
+        node = c;
+    }
+    return false;
+}
+
+bool HuffmanDecoder::loadLegacy(const std::string& combined, uint64_t& bitCount) {
+    // 位串只含 0/1，最后一个 '|' 即码表与位串的分隔符
+    size_t sep = combined.rfind('|');
+    if (sep == std::string::npos || sep == 0) return false;
+
+    reset();
+    const char* p = combined.data();
+    size_t pos = combined.find('|');  // 跳过类型标记 TEXT / IMAGE
+    if (pos == std::string::npos || pos >= sep) return false;
+    ++pos;
+
+    size_t codes = 0;
+    size_t zeroLength = 0;
+    while (pos < sep) {
+        size_t end = combined.find('|', pos);
+        if (end == pos) { ++pos; continue; }
+        uint32_t sym = 0;
+        auto res = std::from_chars(p + pos, p + end, sym);
+        if (res.ec != std::errc() || res.ptr != p + end) return false;
+
+        pos = end + 1;
+        if (pos > sep) return false;
+        end = combined.find('|', pos);
+        if (end > sep) return false;
+        uint32_t bits = 0;
+        unsigned len = (unsigned)(end - pos);
+        if (len > HuffmanEncoder::kMaxCodeLen) return false;
+        for (size_t i = pos; i < end; ++i) {
+            if (p[i] != '0' && p[i] != '1') return false;
+            bits = (bits << 1) | (uint32_t)(p[i] - '0');
+        }
+        // 旧版 HuffmanTree 对只含一种字符的文本给出空码字（如 "TEXT|97||"）
+        if (len == 0) ++zeroLength;
+        else if (!addCode(sym, bits, len)) return false;
+        ++codes;
+        pos = end + 1;
+    }
+    if (codes == 0) return false;
+
+    bitCount = combined.size() - sep - 1;
+    if (zeroLength > 0) {
+        // 空码字只能是整张码表唯一的一项，且旧编码器不写任何位；
+        // 原文长度没有记录，与旧版解码一样得到空文本
+        if (codes != 1 || bitCount != 0) return false;
+        m_packed.clear();
+        return true;
+    }
+    finalize();
+
+    m_packed.assign((size_t)((bitCount + 7) / 8), 0);
+    for (uint64_t i = 0; i < bitCount; ++i) {
+        char c = p[sep + 1 + i];
+        if (c == '1') m_packed[(size_t)(i >> 3)] |= (uint8_t)(0x80 >> (i & 7));
+        else if (c != '0') return false;
+    }
+    return true;
+}
+
+bool HuffmanDecoder::decodeTextUtf8(const std::string& combined, std::string& out) {
+    out.clear();
+    uint64_t bitCount = 0;
+    if (!loadLegacy(combined, bitCount)) return false;
+
+    const bool runLength = combined.compare(0, 8, "TEXTRLE|") == 0;
+    m_wtext.clear();
+    BitReader br(m_packed.data(), bitCount);
+    uint32_t sym = 0;
+    // 按已读的位数汇报
+    if (!progressBegin(m_progress, JobProgress::Decoding, bitCount)) return false;
+    uint64_t nextReport = kProgressBlock;
+    while (br.remaining() > 0) {
+        if (br.position() >= nextReport) {
+            if (!progressAt(m_progress, br.position())) return false;
+            nextReport = br.position() + kProgressBlock;
+        }
+        if (!decodeSymbol(br, sym)) return false;
+        if (sym < HuffmanEncoder::kTextAlphabet) {
+            m_wtext.push_back((wchar_t)sym);
+            continue;
+        }
+        unsigned code = sym - HuffmanEncoder::kTextAlphabet;
+        if (!runLength || code >= kRunCodeCount || m_wtext.empty()) return false;
+        unsigned extra = kRunExtra[code];
+        if (br.remaining() < extra) return false;
+        uint32_t len = kRunBase[code] + br.read(extra);
+        m_wtext.append(len, m_wtext.back());
+    }
+    if (m_wtext.empty()) return true;
+
+    int len = WideCharToMultiByte(CP_UTF8, 0, m_wtext.data(), (int)m_wtext.size(), NULL, 0, NULL, NULL);
+    if (len <= 0) return false;
+    out.resize(len);
+    WideCharToMultiByte(CP_UTF8, 0, m_wtext.data(), (int)m_wtext.size(), &out[0], len, NULL, NULL);
+    return true;
+}
@@ -99,6 +99,16 @@ void HuffmanTree::destroyNode(HuffmanNode* node) {
     }
 }
 
+uint64_t HuffmanTree::leafCodeKey(const HuffmanNode* leaf) {
+    uint64_t bits = 0;
+    unsigned len = 0;
+    for (const HuffmanNode* current = leaf; current->parent != nullptr; current = current->parent) {
+        if (current == current->parent->right) bits |= 1ULL << len;
+        ++len;
+    }
+    return packCodeKey(bits, len);
+}
+
 // 构建文本哈夫曼树
 void HuffmanTree::buildForText(const std::vector<std::pair<wchar_t, int>>& freqVec) {
    destroyNode(root);
@@ -115,7 +125,6 @@ void HuffmanTree::buildForText(const std::vector<std::pair<wchar_t, int>>& freqV
             HuffmanNode* newNode = new HuffmanNode(p.first, p.second);
             nodes.push_back(newNode);
             leafnodes.push_back(newNode);
-            charToCode[p.first] = L"";
         }
 
         while (nodes.size() > 1) {
@@ -149,17 +158,8 @@ void HuffmanTree::buildForText(const std::vector<std::pair<wchar_t, int>>& freqV
         }
 
         for (size_t i = 0; i < leafnodes.size(); ++i) {
-            HuffmanNode* current = leafnodes[i];
-            std::wstring code = L"";
-            while (current->parent != nullptr) {
-                if (current == current->parent->left) {
-                    code = L"0" + code;
-                } else {
-                    code = L"1" + code;
-                }
-                current = current->parent;
-            }
             // 文本树：填充字符->编码 和 编码->字符 映射
+            uint64_t code = leafCodeKey(leafnodes[i]);
             wchar_t ch = leafnodes[i]->ch;
             charToCode[ch] = code;
             codeToChar[code] = ch;
@@ -183,7 +183,6 @@ void HuffmanTree::buildForImage(const std::vector<std::pair<BYTE, int>>& freqVec
             HuffmanNode* newNode = new HuffmanNode(p.first, p.second);
             nodes.push_back(newNode);
             leafnodes.push_back(newNode);
-            byteToCode[p.first] = L"";
         }
 
         while (nodes.size() > 1) {
@@ -216,28 +215,23 @@ void HuffmanTree::buildForImage(const std::vector<std::pair<BYTE, int>>& freqVec
         }
 
         for (size_t i = 0; i < leafnodes.size(); ++i) {
-            HuffmanNode* current = leafnodes[i];
-            std::wstring code = L"";
-            while (current->parent != nullptr) {
-                if (current == current->parent->left) {
-                    code = L"0" + code;
-                } else {
-                    code = L"1" + code;
-                }
-                current = current->parent;
-            }
+            uint64_t code = leafCodeKey(leafnodes[i]);
             byteToCode[leafnodes[i]->byte] = code;
             codeToByte[code] = leafnodes[i]->byte;
         }
 }
 
-// 获取编码映射表
+// 获取编码映射表（按需展开为码字串）
 std::unordered_map<wchar_t, std::wstring> HuffmanTree::getCharCodeMap() const {
-    return charToCode;
+    std::unordered_map<wchar_t, std::wstring> result;
+    charToCode.forEach([&result](uint64_t ch, uint64_t code) { result[(wchar_t)ch] = codeKeyToString(code); });
+    return result;
 }
 
 std::unordered_map<BYTE, std::wstring> HuffmanTree::getByteCodeMap() const {
-    return byteToCode;
+    std::unordered_map<BYTE, std::wstring> result;
+    byteToCode.forEach([&result](uint64_t b, uint64_t code) { result[(BYTE)b] = codeKeyToString(code); });
+    return result;
 }
 
 // 解码方法
@@ -245,16 +239,19 @@ std::wstring HuffmanTree::decodeText(const std::wstring& code) const {
     if (codeToChar.empty()) return L"";
         
         std::wstring result = L"";
-        std::wstring currentCode;
+        uint64_t bits = 0;
+        unsigned len = 0;
         for (wchar_t bit : code) {
-            currentCode += bit;
-            auto it = codeToChar.find(currentCode);
-            if (it != codeToChar.end()) {
-                result += it->second;
-                currentCode.clear();
+            if (bit != L'0' && bit != L'1') return L"解码错误：存在无效编码";
+            bits = bits << 1 | (uint64_t)(bit == L'1');
+            if (++len > kMaxPackedCodeLen) return L"解码错误：存在无效编码";
+            if (const wchar_t* ch = codeToChar.find(packCodeKey(bits, len))) {
+                result += *ch;
+                bits = 0;
+                len = 0;
             }
         }
-        if (!currentCode.empty()) {
+        if (len != 0) {
             return L"解码错误：存在无效编码";
         }
         return result;
@@ -264,16 +261,19 @@ std::vector<BYTE> HuffmanTree::decodeImage(const std::wstring& code) const {
     if (codeToByte.empty()) return {};
         
         std::vector<BYTE> result;
-        std::wstring currentCode;
+        uint64_t bits = 0;
+        unsigned len = 0;
         for (wchar_t bit : code) {
-            currentCode += bit;
-            auto it = codeToByte.find(currentCode);
-            if (it != codeToByte.end()) {
-                result.push_back(it->second);
-                currentCode.clear();
+            if (bit != L'0' && bit != L'1') return {};
+            bits = bits << 1 | (uint64_t)(bit == L'1');
+            if (++len > kMaxPackedCodeLen) return {};
+            if (const BYTE* b = codeToByte.find(packCodeKey(bits, len))) {
+                result.push_back(*b);
+                bits = 0;
+                len = 0;
             }
         }
-        if (!currentCode.empty()) {
+        if (len != 0) {
             return {};  // 解码失败
         }
         return result;
@@ -282,29 +282,32 @@ std::vector<BYTE> HuffmanTree::decodeImage(const std::wstring& code) const {
 std::vector<BYTE> HuffmanTree::decodeImageFromBits(const uint8_t* bytes, uint64_t bitCount) const {
     if (codeToByte.empty()) return {};
         std::vector<BYTE> result;
-        std::wstring currentCode;
+        uint64_t bits = 0;
+        unsigned len = 0;
         for (uint64_t i = 0; i < bitCount; ++i) {
             uint64_t byteIndex = i / 8;
             int bitIndex = 7 - (int)(i % 8);
-            int bit = (bytes[byteIndex] >> bitIndex) & 1;
-            currentCode.push_back(bit ? L'1' : L'0');
-            auto it = codeToByte.find(currentCode);
-            if (it != codeToByte.end()) {
-                result.push_back(it->second);
-                currentCode.clear();
+            bits = bits << 1 | (uint64_t)((bytes[byteIndex] >> bitIndex) & 1);
+            if (++len > kMaxPackedCodeLen) return {};
+            if (const BYTE* b = codeToByte.find(packCodeKey(bits, len))) {
+                result.push_back(*b);
+                bits = 0;
+                len = 0;
             }
         }
-        if (!currentCode.empty()) return {};
+        if (len != 0) return {};
         return result;
 }
 
 // 编码方法
 std::wstring HuffmanTree::encodeText(const std::wstring& text, const std::unordered_map<wchar_t, std::wstring>& codeMap) {
+    // 先把码表转成平坦表，逐字符查找时不再走 unordered_map 的桶链
+    FlatHashMap<const std::wstring*> lookup;
+    for (const auto& p : codeMap) lookup[(uint64_t)p.first] = &p.second;
     std::wstring encoded;
     for (wchar_t ch : text) {
-        auto it = codeMap.find(ch);
-        if (it != codeMap.end()) {
-            encoded += it->second;
+        if (const std::wstring* const* code = lookup.find((uint64_t)ch)) {
+            encoded += **code;
         }
     }
     return encoded;
@@ -312,14 +315,13 @@ std::wstring HuffmanTree::encodeText(const std::wstring& text, const std::unorde
 
 // 新增：编码图片字节数据
 std::wstring encodeImage(const std::vector<BYTE>& data, const std::unordered_map<BYTE, std::wstring>& codeMap) {
-        std::wstring encoded;
+    // 字节只有 256 种，直接用下标表
+    const std::wstring* lookup[256] = {};
+    for (const auto& p : codeMap) lookup[p.first] = &p.second;
+    std::wstring encoded;
     for (BYTE b : data) {
-        auto it = codeMap.find(b);
-        if (it != codeMap.end()) {
-            encoded += it->second;
-        } else {
-            return L"";
-        }
+        if (!lookup[b]) return L"";
+        encoded += *lookup[b];
     }
     return encoded;
 }
@@ -330,23 +332,22 @@ std::wstring HuffmanTree::serializeCodes() const {
         std::wstringstream ss;
         ss << (isImageTree ? L"IMAGE" : L"TEXT") << L"|";  // 标记类型
         
+        auto write = [&ss](uint64_t sym, uint64_t code) {
+            ss << (int)sym << L"|" << codeKeyToString(code) << L"|";
+        };
         if (isImageTree) {
-            for (const auto& p : byteToCode) {
-                ss << (int)p.first << L"|" << p.second << L"|";
-            }
+            byteToCode.forEach(write);
         } else {
-            for (const auto& p : charToCode) {
-                ss << (int)p.first << L"|" << p.second << L"|";
-            }
+            charToCode.forEach(write);
         }
         return ss.str();
 }
 
 std::wstring HuffmanTree::serializeTextCodes() const {
         std::wstringstream ss;
-        for (const auto& p : charToCode) {
-            ss << (int)p.first << L"|" << p.second << L"|";
-        }
+        charToCode.forEach([&ss](uint64_t ch, uint64_t code) {
+            ss << (int)ch << L"|" << codeKeyToString(code) << L"|";
+        });
         return ss.str();
 }
 
@@ -365,9 +366,11 @@ bool HuffmanTree::deserializeTextCodes(const std::wstring& data) {
                 return false;
             }
             if (!getline(ss, part, L'|')) return false;
+            uint64_t code;
+            if (!codeStringToKey(part, code)) return false;
             wchar_t ch = (wchar_t)charCode;
-            charToCode[ch] = part;
-            codeToChar[part] = ch;
+            charToCode[ch] = code;
+            codeToChar[code] = ch;
         }
         return !charToCode.empty();
 }
@@ -394,15 +397,17 @@ bool HuffmanTree::deserializeCodes(const std::wstring& data) {
                 return false;
             }
             if (!getline(ss, part, L'|')) return false;
+            uint64_t code;
+            if (!codeStringToKey(part, code)) return false;
             
             if (isImageTree) {
                 BYTE b = (BYTE)val;
-                byteToCode[b] = part;
-                codeToByte[part] = b;
+                byteToCode[b] = code;
+                codeToByte[code] = b;
             } else {
                 wchar_t ch = (wchar_t)val;
-                charToCode[ch] = part;
-                codeToChar[part] = ch;
+                charToCode[ch] = code;
+                codeToChar[code] = ch;
             }
         }
         return isImageTree ? !byteToCode.empty() : !charToCode.empty();
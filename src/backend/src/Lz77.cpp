@@ -0,0 +1,152 @@
+#include "Lz77.h"
+#include "HuffmanCodec.h"
+#include <algorithm>
+
+static const unsigned kHashBits = 15;
+
+Lz77Params lz77ParamsForLevel(int level) {
+    // 窗口位数、链长、足够长的匹配长度、是否惰性匹配
+    static const Lz77Params kLevels[kLz77MaxLevel] = {
+        {12, 4, 16, false},
+        {13, 8, 32, false},
+        {14, 16, 32, false},
+        {15, 16, 64, true},
+        {15, 32, 128, true},
+        {15, 128, 128, true},
+        {16, 256, 258, true},
+        {17, 512, 258, true},
+        {18, 1024, 258, true},
+    };
+    level = std::min(std::max(level, kLz77MinLevel), kLz77MaxLevel);
+    return kLevels[level - 1];
+}
+
+unsigned distanceCode(uint32_t dist) {
+    if (dist <= 4) return dist - 1;
+    uint32_t x = dist - 1;
+    unsigned high = 31;
+    while (!(x >> high)) --high;
+    return 2 * high + ((x >> (high - 1)) & 1);
+}
+
+uint32_t distanceBase(unsigned code) {
+    if (code < 4) return code + 1;
+    unsigned k = code / 2;
+    return (1u << k) + (code & 1) * (1u << (k - 1)) + 1;
+}
+
+unsigned distanceExtra(unsigned code) {
+    return code < 4 ? 0 : code / 2 - 1;
+}
+
+static inline uint32_t hash3(const uint8_t* p) {
+    uint32_t v = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+    return (v * 2654435761u) >> (32 - kHashBits);
+}
+
+void Lz77Matcher::insert(const uint8_t* data, size_t pos) {
+    uint32_t h = hash3(data + pos);
+    m_prev[pos & m_windowMask] = m_head[h];
+    m_head[h] = (int32_t)pos;
+}
+
+uint32_t Lz77Matcher::findMatch(const uint8_t* data, size_t size, size_t pos, const Lz77Params& params,
+                                uint32_t& dist) const {
+    const size_t window = m_windowMask + 1;
+    const uint32_t maxLen = (uint32_t)std::min<size_t>(kMaxRun, size - pos);
+    uint32_t best = 0;
+    unsigned chain = params.maxChain;
+    int32_t cand = m_head[hash3(data + pos)];
+    // 超出窗口的候选其链表槽位可能已被新位置覆盖，按距离截止
+    while (cand >= 0 && pos - (size_t)cand <= window && chain-- > 0) {
+        const uint8_t* a = data + cand;
+        const uint8_t* b = data + pos;
+        // 先比较当前最优长度处的字节，多数候选在这里就被排除
+        if (a[best] == b[best] && a[0] == b[0]) {
+            uint32_t len = 0;
+            while (len < maxLen && a[len] == b[len]) ++len;
+            if (len > best) {
+                best = len;
+                dist = (uint32_t)(pos - cand);
+                if (len >= params.niceLength || len == maxLen) break;
+            }
+        }
+        cand = m_prev[cand & m_windowMask];
+    }
+    return best >= kMinRun ? best : 0;
+}
+
+bool Lz77Matcher::parse(const uint8_t* data, size_t size, const Lz77Params& params, std::vector<Lz77Token>& tokens) {
+    tokens.clear();
+    const unsigned windowBits = std::min(params.windowBits, kLz77MaxWindowBits);
+    m_windowMask = ((size_t)1 << windowBits) - 1;
+    m_head.assign((size_t)1 << kHashBits, -1);
+    m_prev.assign(m_windowMask + 1, -1);
+
+    auto literal = [&](size_t pos) {
+        Lz77Token t;
+        t.value = data[pos];
+        tokens.push_back(t);
+    };
+    auto match = [&](uint32_t len, uint32_t dist) {
+        Lz77Token t;
+        t.length = len;
+        t.value = dist;
+        tokens.push_back(t);
+    };
+    // 被匹配覆盖的位置也要进哈希链，后面的数据才能引用它们
+    auto insertRange = [&](size_t from, size_t to) {
+        for (size_t j = from; j < to && j + kMinRun <= size; ++j) insert(data, j);
+    };
+
+    bool havePrev = false;
+    uint32_t prevLen = 0, prevDist = 0;
+    size_t i = 0;
+    if (!progressBegin(m_progress, JobProgress::Analyzing, size)) return false;
+    size_t nextReport = kProgressBlock;
+    while (i < size) {
+        if (i >= nextReport) {
+            if (!progressAt(m_progress, i)) return false;
+            nextReport = i + kProgressBlock;
+        }
+        uint32_t len = 0, dist = 0;
+        if (i + kMinRun <= size) {
+            len = findMatch(data, size, i, params, dist);
+            insert(data, i);
+        }
+
+        if (havePrev) {
+            if (len > prevLen) {
+                // 当前位置匹配更长：前一位置退化为字面量，继续观察下一位置
+                literal(i - 1);
+                prevLen = len;
+                prevDist = dist;
+                ++i;
+                continue;
+            }
+            match(prevLen, prevDist);
+            size_t end = i - 1 + prevLen;
+            insertRange(i + 1, end);
+            i = end;
+            havePrev = false;
+            continue;
+        }
+
+        if (len > 0) {
+            if (params.lazy && len < params.niceLength) {
+                havePrev = true;
+                prevLen = len;
+                prevDist = dist;
+                ++i;
+                continue;
+            }
+            match(len, dist);
+            insertRange(i + 1, i + len);
+            i += len;
+            continue;
+        }
+        literal(i);
+        ++i;
+    }
+    return progressAt(m_progress, size);
+}
@@ -0,0 +1,309 @@
+#include "MultiTableCodec.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+// 选表时未出现在某张码表中的符号按这个码长估价（重建码表后该符号会被补进去）
+static const uint8_t kMissingCodeLen = 20;
+// 初始划分：码表负责区间内的符号估价 0，其余 15（同 bzip2）
+static const uint8_t kInitialOutsideLen = 15;
+
+bool MultiTableCodec::encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    return encodeAll(data, size, 256, out);
+}
+
+bool MultiTableCodec::encode(const std::wstring& text, std::vector<uint8_t>& out) {
+    return encodeAll(text.data(), text.size(), HuffmanEncoder::kTextAlphabet, out);
+}
+
+template <typename Sym>
+bool MultiTableCodec::encodeAll(const Sym* data, size_t size, uint32_t alphabet, std::vector<uint8_t>& out) {
+    appendVarint(out, size);
+    // 块（kMultiTableBlockSymbols 个符号）是选表迭代的单位，块之间汇报进度
+    if (!progressBegin(m_progress, JobProgress::Encoding, size)) return false;
+    for (size_t pos = 0; pos < size; pos += kMultiTableBlockSymbols) {
+        if (!progressAt(m_progress, pos)) return false;
+        size_t count = std::min<size_t>(kMultiTableBlockSymbols, size - pos);
+        m_block.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t sym = (uint32_t)data[pos + i];
+            if (sym >= alphabet) return false;
+            m_block[i] = sym;
+        }
+        if (!encodeBlock(alphabet, out)) return false;
+    }
+    return progressAt(m_progress, size);
+}
+
+// 迭代求码表与选择子：初始按累计频率把符号区间平分给各码表，
+// 之后每轮按当前码长给每组选最省的码表，再用各码表分到的组重建码长。
+// 结束时 m_encoders[0..T) 与 m_selectors 一致，空码表已去掉，返回实际码表数
+void MultiTableCodec::chooseTables(unsigned tableCount) {
+    const size_t count = m_local.size();
+    const uint32_t n = (uint32_t)m_symbols.size();
+    const size_t groups = (count + kMultiTableGroupSize - 1) / kMultiTableGroupSize;
+    m_selectors.assign(groups, 0);
+    if (m_encoders.size() < tableCount) m_encoders.resize(tableCount);
+
+    std::vector<uint64_t> freq(n, 0);
+    for (uint32_t s : m_local) freq[s]++;
+    m_lengths.assign((size_t)n * tableCount, kInitialOutsideLen);
+    uint64_t remaining = count;
+    uint32_t s = 0;
+    for (unsigned t = 0; t < tableCount; ++t) {
+        uint64_t target = remaining / (tableCount - t);
+        uint64_t acc = 0;
+        while (s < n && (acc < target || t + 1 == tableCount)) {
+            acc += freq[s];
+            m_lengths[(size_t)s * tableCount + t] = 0;
+            ++s;
+        }
+        remaining -= acc;
+    }
+
+    for (unsigned iter = 0; iter < kMultiTableIterations; ++iter) {
+        for (unsigned t = 0; t < tableCount; ++t) m_encoders[t].reset(n);
+        for (size_t g = 0; g < groups; ++g) {
+            size_t begin = g * kMultiTableGroupSize;
+            size_t end = std::min(count, begin + kMultiTableGroupSize);
+            uint32_t cost[kMaxMultiTables] = {};
+            for (size_t i = begin; i < end; ++i) {
+                const uint8_t* len = &m_lengths[(size_t)m_local[i] * tableCount];
+                for (unsigned t = 0; t < tableCount; ++t) cost[t] += len[t];
+            }
+            unsigned best = 0;
+            for (unsigned t = 1; t < tableCount; ++t) {
+                if (cost[t] < cost[best]) best = t;
+            }
+            m_selectors[g] = (uint8_t)best;
+            for (size_t i = begin; i < end; ++i) m_encoders[best].count(m_local[i]);
+        }
+        for (unsigned t = 0; t < tableCount; ++t) {
+            HuffmanEncoder& enc = m_encoders[t];
+            if (!enc.usedSymbols().empty()) enc.buildCodes();
+            for (uint32_t sym = 0; sym < n; ++sym) {
+                m_lengths[(size_t)sym * tableCount + t] = enc.frequency(sym) ? enc.code(sym).len : kMissingCodeLen;
+            }
+        }
+    }
+
+    // 去掉没有被任何组选中的码表，编号压紧
+    int remap[kMaxMultiTables];
+    std::fill(remap, remap + kMaxMultiTables, -1);
+    int next = 0;
+    for (unsigned t = 0; t < tableCount; ++t) {
+        if (m_encoders[t].usedSymbols().empty()) continue;
+        if ((int)t != next) std::swap(m_encoders[next], m_encoders[t]);
+        remap[t] = next++;
+    }
+    for (uint8_t& sel : m_selectors) sel = (uint8_t)remap[sel];
+}
+
+bool MultiTableCodec::encodeBlock(uint32_t alphabet, std::vector<uint8_t>& out) {
+    const size_t count = m_block.size();
+    m_localIndex.assign(alphabet, -1);
+    m_symbols.clear();
+    for (uint32_t sym : m_block) {
+        if (m_localIndex[sym] < 0) {
+            m_localIndex[sym] = 0;
+            m_symbols.push_back(sym);
+        }
+    }
+    std::sort(m_symbols.begin(), m_symbols.end());
+    for (size_t i = 0; i < m_symbols.size(); ++i) m_localIndex[m_symbols[i]] = (int32_t)i;
+    const uint32_t n = (uint32_t)m_symbols.size();
+    m_local.resize(count);
+    for (size_t i = 0; i < count; ++i) m_local[i] = (uint32_t)m_localIndex[m_block[i]];
+
+    // 码表数沿用 bzip2 按块长的分档；符号种类多时码表本身占空间，再按 n 收紧
+    unsigned tableCount = count < 200 ? 1 : count < 600 ? 2 : count < 1200 ? 3 : count < 2400 ? 4 : count < 4800 ? 5 : 6;
+    while (tableCount > 1 && (uint64_t)tableCount * n * 8 > count) --tableCount;
+    chooseTables(tableCount);
+    tableCount = 0;
+    for (uint8_t sel : m_selectors) tableCount = std::max<unsigned>(tableCount, sel + 1u);
+
+    m_body.clear();
+    appendVarint(m_body, n);
+    uint32_t prev = 0;
+    for (uint32_t sym : m_symbols) {
+        appendVarint(m_body, sym - prev);
+        prev = sym;
+    }
+    appendVarint(m_body, tableCount);
+    for (unsigned t = 0; t < tableCount; ++t) m_encoders[t].writeLengths(m_body);
+
+    size_t bitsPos = m_body.size();
+    appendLE(m_body, 0, 8);
+    BitWriter bw(m_body);
+    // 选择子先做 move-to-front：相邻组多半选同一张表，MTF 后大多为 0，一元码只占 1 位
+    uint8_t mtf[kMaxMultiTables];
+    for (unsigned t = 0; t < kMaxMultiTables; ++t) mtf[t] = (uint8_t)t;
+    for (uint8_t sel : m_selectors) {
+        unsigned j = 0;
+        while (mtf[j] != sel) ++j;
+        bw.write((1u << (j + 1)) - 2, j + 1);
+        std::copy_backward(mtf, mtf + j, mtf + j + 1);
+        mtf[0] = sel;
+    }
+    for (size_t g = 0; g < m_selectors.size(); ++g) {
+        const HuffmanEncoder& enc = m_encoders[m_selectors[g]];
+        size_t end = std::min(count, (g + 1) * kMultiTableGroupSize);
+        for (size_t i = g * kMultiTableGroupSize; i < end; ++i) enc.put(m_local[i], bw);
+    }
+    bw.flush();
+    for (unsigned i = 0; i < 8; ++i) m_body[bitsPos + i] = (uint8_t)(bw.bitCount() >> (8 * i));
+
+    appendVarint(out, count);
+    appendVarint(out, m_body.size());
+    out.insert(out.end(), m_body.begin(), m_body.end());
+    return true;
+}
+
+bool MultiTableCodec::scanBlocks(const uint8_t*& p, const uint8_t* end, uint64_t& total) {
+    m_blocks.clear();
+    if (!readVarint(p, end, total)) return false;
+    // 每个符号至少占 1 位
+    if (total > (uint64_t)(end - p) * 8) return false;
+    uint64_t offset = 0;
+    while (offset < total) {
+        uint64_t count = 0, bytes = 0;
+        if (!readVarint(p, end, count) || count == 0 || count > kMultiTableBlockSymbols) return false;
+        if (!readVarint(p, end, bytes) || bytes > (uint64_t)(end - p)) return false;
+        if (count > total - offset) return false;
+        BlockRef block;
+        block.body = p;
+        block.end = p + bytes;
+        block.offset = offset;
+        block.count = (uint32_t)count;
+        m_blocks.push_back(block);
+        p += bytes;
+        offset += count;
+    }
+    return true;
+}
+
+bool MultiTableCodec::decodeBlock(const BlockRef& block, uint32_t alphabet, BlockDecoder& state) {
+    const uint8_t* p = block.body;
+    const uint8_t* end = block.end;
+    uint64_t n = 0, tableCount = 0, v = 0;
+    if (!readVarint(p, end, n) || n == 0 || n > alphabet) return false;
+    state.symbols.resize((size_t)n);
+    uint64_t sym = 0;
+    for (uint64_t i = 0; i < n; ++i) {
+        if (!readVarint(p, end, v)) return false;
+        sym += v;
+        if (sym >= alphabet || (i > 0 && v == 0)) return false;
+        state.symbols[(size_t)i] = (uint32_t)sym;
+    }
+    if (!readVarint(p, end, tableCount) || tableCount == 0 || tableCount > kMaxMultiTables) return false;
+    if (state.tables.size() < tableCount) state.tables.resize((size_t)tableCount);
+    for (uint64_t t = 0; t < tableCount; ++t) {
+        if (!state.tables[(size_t)t].readLengths(p, end, (uint32_t)n)) return false;
+    }
+    uint64_t bits = 0;
+    if (!readLE(p, end, bits, 8)) return false;
+    if ((uint64_t)(end - p) != (bits + 7) / 8 || block.count > bits) return false;
+
+    BitReader br(p, bits);
+    const size_t groups = (block.count + kMultiTableGroupSize - 1) / kMultiTableGroupSize;
+    state.selectors.resize(groups);
+    uint8_t mtf[kMaxMultiTables];
+    for (unsigned t = 0; t < kMaxMultiTables; ++t) mtf[t] = (uint8_t)t;
+    for (size_t g = 0; g < groups; ++g) {
+        unsigned j = 0;
+        while (br.read(1)) {
+            if (++j >= tableCount) return false;
+        }
+        uint8_t sel = mtf[j];
+        std::copy_backward(mtf, mtf + j, mtf + j + 1);
+        mtf[0] = sel;
+        state.selectors[g] = sel;
+    }
+    if (br.position() > bits) return false;
+
+    state.local.resize(block.count);
+    uint32_t local = 0;
+    for (size_t g = 0; g < groups; ++g) {
+        const HuffmanDecoder& dec = state.tables[state.selectors[g]];
+        size_t last = std::min<size_t>(block.count, (g + 1) * kMultiTableGroupSize);
+        for (size_t i = g * kMultiTableGroupSize; i < last; ++i) {
+            if (!dec.decodeSymbol(br, local)) return false;
+            state.local[i] = state.symbols[local];
+        }
+    }
+    return br.remaining() == 0;
+}
+
+template <typename Sym>
+bool MultiTableCodec::decodeAll(uint32_t alphabet, Sym* out) {
+    unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    workers = (unsigned)std::min<size_t>(workers, m_blocks.size());
+    if (m_workers.size() < std::max(1u, workers)) m_workers.resize(std::max(1u, workers));
+
+    auto emit = [&](const BlockRef& block, const BlockDecoder& state) {
+        Sym* dst = out + block.offset;
+        for (uint32_t i = 0; i < block.count; ++i) dst[i] = (Sym)state.local[i];
+    };
+    // 已解出的符号数；多线程时各线程完成一块就累加一次
+    std::atomic<uint64_t> decoded(0);
+    auto blockDone = [&](const BlockRef& block) {
+        return progressAt(m_progress, decoded += block.count);
+    };
+    if (workers <= 1) {
+        for (const BlockRef& block : m_blocks) {
+            if (!decodeBlock(block, alphabet, m_workers[0])) return false;
+            emit(block, m_workers[0]);
+            if (!blockDone(block)) return false;
+        }
+        return true;
+    }
+
+    // 块之间互不依赖，各线程轮流领取块号，写入输出中各自不重叠的区间
+    std::atomic<size_t> nextBlock(0);
+    std::atomic<bool> ok(true);
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < workers; ++w) {
+        threads.emplace_back([&, w]() {
+            BlockDecoder& state = m_workers[w];
+            for (size_t b = nextBlock++; b < m_blocks.size() && ok; b = nextBlock++) {
+                if (!decodeBlock(m_blocks[b], alphabet, state)) {
+                    ok = false;
+                    return;
+                }
+                emit(m_blocks[b], state);
+                if (!blockDone(m_blocks[b])) {
+                    ok = false;
+                    return;
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    return ok;
+}
+
+bool MultiTableCodec::decode(const uint8_t*& p, const uint8_t* end, std::vector<uint8_t>& out) {
+    out.clear();
+    uint64_t total = 0;
+    if (!scanBlocks(p, end, total)) return false;
+    if (!progressBegin(m_progress, JobProgress::Decoding, total)) return false;
+    out.resize((size_t)total);
+    if (!decodeAll(256, out.data())) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+bool MultiTableCodec::decode(const uint8_t*& p, const uint8_t* end, std::wstring& text) {
+    text.clear();
+    uint64_t total = 0;
+    if (!scanBlocks(p, end, total)) return false;
+    if (!progressBegin(m_progress, JobProgress::Decoding, total)) return false;
+    text.resize((size_t)total);
+    if (!decodeAll(HuffmanEncoder::kTextAlphabet, &text[0])) {
+        text.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,352 @@
+#include "PhufFormat.h"
+#include "ImageFilter.h"
+#include <algorithm>
+#include <windows.h>
+
+static const uint8_t kPhufMagic[4] = {'P', 'H', 'U', 'F'};
+static const size_t kPhufHeaderSize = 16;
+
+static void writePhufHeader(std::vector<uint8_t>& out, uint8_t flags, uint64_t original) {
+    out.clear();
+    out.reserve(kPhufHeaderSize + 10);
+    out.insert(out.end(), kPhufMagic, kPhufMagic + 4);
+    out.push_back(kPhufVersion);
+    out.push_back(flags);
+    appendLE(out, 0, 2);
+    appendLE(out, original, 8);
+}
+
+static bool validImageInfo(const PhufImageInfo& info) {
+    return info.width >= 0 && info.height >= 0 && info.bitsPerPixel >= 8 && info.bitsPerPixel % 8 == 0 &&
+           info.bitsPerPixel <= 64;
+}
+
+// UTF-8 <-> UTF-16 码元；文本类模式只接受 BMP 内字符（与 HuffmanEncoder::kTextAlphabet 一致）
+// 非法 UTF-8 直接失败：替换成 U+FFFD 后解码出的字节就和原文不同了
+static bool utf8ToText(const std::string& utf8, std::wstring& text) {
+    int wlen = 0;
+    if (!utf8.empty()) {
+        wlen = MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, utf8.data(), (int)utf8.size(), NULL, 0);
+        if (wlen <= 0) return false;
+    }
+    text.resize(wlen);
+    if (wlen > 0) MultiByteToWideChar(CP_UTF8, MB_ERR_INVALID_CHARS, utf8.data(), (int)utf8.size(), &text[0], wlen);
+    for (wchar_t wc : text) {
+        if ((uint32_t)wc >= HuffmanEncoder::kTextAlphabet) return false;
+    }
+    return true;
+}
+
+static bool textToUtf8(const std::wstring& text, uint64_t expected, std::vector<uint8_t>& out) {
+    out.clear();
+    if (!text.empty()) {
+        int len = WideCharToMultiByte(CP_UTF8, 0, text.data(), (int)text.size(), NULL, 0, NULL, NULL);
+        if (len <= 0 || (uint64_t)len != expected) return false;
+        out.resize((size_t)len);
+        WideCharToMultiByte(CP_UTF8, 0, text.data(), (int)text.size(), reinterpret_cast<char*>(out.data()), len,
+                            NULL, NULL);
+    }
+    return out.size() == expected;
+}
+
+bool PhufCodec::isPhuf(const uint8_t* data, size_t size) {
+    return size >= kPhufHeaderSize && data[0] == kPhufMagic[0] && data[1] == kPhufMagic[1] &&
+           data[2] == kPhufMagic[2] && data[3] == kPhufMagic[3];
+}
+
+bool PhufCodec::encodePayload(const uint8_t* data, size_t size, uint8_t flags, std::vector<uint8_t>& out) {
+    if (flags & PHUF_FLAG_MULTI) return m_multi.encode(data, size, out);
+    return m_encoder.encodeBytes(data, size, out, (flags & PHUF_FLAG_RLE) != 0);
+}
+
+bool PhufCodec::decodePayload(const uint8_t*& p, const uint8_t* end, uint8_t flags, std::vector<uint8_t>& out) {
+    if (flags & PHUF_FLAG_MULTI) return m_multi.decode(p, end, out);
+    return m_decoder.decodeBytes(p, end, out, (flags & PHUF_FLAG_RLE) != 0);
+}
+
+bool PhufCodec::encode(const uint8_t* data, size_t size, std::vector<uint8_t>& out, uint8_t flags) {
+    flags &= (flags & PHUF_FLAG_MULTI) ? PHUF_FLAG_MULTI : PHUF_FLAG_RLE;
+    writePhufHeader(out, flags, size);
+    return encodePayload(data, size, flags, out);
+}
+
+bool PhufCodec::encodePixels(const uint8_t* pixels, const PhufImageInfo& info, uint8_t flags, std::vector<uint8_t>& out) {
+    out.clear();
+    if (!validImageInfo(info)) return false;
+    const int bytesPerPixel = info.bitsPerPixel / 8;
+    const size_t size = (size_t)info.width * info.height * bytesPerPixel;
+
+    flags = PHUF_FLAG_PIXELS | (flags & (PHUF_FLAG_PREDICT | PHUF_FLAG_RLE | PHUF_FLAG_MULTI));
+    if (flags & PHUF_FLAG_MULTI) flags &= ~PHUF_FLAG_RLE;
+    const bool predict = (flags & PHUF_FLAG_PREDICT) != 0;
+    writePhufHeader(out, flags, size);
+    appendLE(out, (uint32_t)info.width, 4);
+    appendLE(out, (uint32_t)info.height, 4);
+    appendLE(out, (uint16_t)info.bitsPerPixel, 2);
+
+    if (!predict) return encodePayload(pixels, size, flags, out);
+    m_filtered.resize(filteredImageSize(info.width, info.height, bytesPerPixel));
+    filterImageRows(pixels, info.width, info.height, bytesPerPixel, m_filtered.data());
+    return encodePayload(m_filtered.data(), m_filtered.size(), flags, out);
+}
+
+bool PhufCodec::encodeLz77(const uint8_t* data, size_t size, int level, std::vector<uint8_t>& out) {
+    writePhufHeader(out, PHUF_FLAG_LZ77, size);
+    if (!m_matcher.parse(data, size, lz77ParamsForLevel(level), m_tokens)) return false;
+
+    // 字面量与长度码共用一张表（长度沿用游程长度码），距离单独一张表
+    m_encoder.reset(256 + kRunCodeCount);
+    m_distEncoder.reset(kDistCodeCount);
+    for (const Lz77Token& t : m_tokens) {
+        if (t.length == 0) {
+            m_encoder.count(t.value);
+        } else {
+            m_encoder.count(256 + runLengthCode(t.length));
+            m_distEncoder.count(distanceCode(t.value));
+        }
+    }
+    if (!m_encoder.usedSymbols().empty() && !m_encoder.buildCodes()) return false;
+    if (!m_distEncoder.usedSymbols().empty() && !m_distEncoder.buildCodes()) return false;
+
+    m_encoder.writeLengths(out);
+    m_distEncoder.writeLengths(out);
+    size_t bitsPos = out.size();
+    appendLE(out, 0, 8);
+    BitWriter bw(out);
+    if (!progressBegin(m_progress, JobProgress::Encoding, m_tokens.size())) return false;
+    for (size_t i = 0; i < m_tokens.size(); ++i) {
+        if ((i & (kProgressBlock - 1)) == kProgressBlock - 1 && !progressAt(m_progress, i)) return false;
+        const Lz77Token& t = m_tokens[i];
+        if (t.length == 0) {
+            m_encoder.put(t.value, bw);
+            continue;
+        }
+        unsigned lc = runLengthCode(t.length);
+        m_encoder.put(256 + lc, bw);
+        bw.write(t.length - runLengthBase(lc), runLengthExtra(lc));
+        unsigned dc = distanceCode(t.value);
+        m_distEncoder.put(dc, bw);
+        bw.write(t.value - distanceBase(dc), distanceExtra(dc));
+    }
+    bw.flush();
+    for (unsigned i = 0; i < 8; ++i) out[bitsPos + i] = (uint8_t)(bw.bitCount() >> (8 * i));
+    return true;
+}
+
+bool PhufCodec::decodeLz77(const uint8_t*& p, const uint8_t* end, uint64_t original, std::vector<uint8_t>& out) {
+    uint64_t bits = 0;
+    if (!m_decoder.readLengths(p, end, 256 + kRunCodeCount)) return false;
+    if (!m_distDecoder.readLengths(p, end, kDistCodeCount)) return false;
+    if (!readLE(p, end, bits, 8)) return false;
+    uint64_t bytes = (bits + 7) / 8;
+    if ((uint64_t)(end - p) < bytes) return false;
+    // 每个符号至少 1 位、最多展开 kMaxRun 字节，超出即为损坏数据
+    if (original > bits * kMaxRun) return false;
+
+    out.reserve((size_t)original);
+    BitReader br(p, bits);
+    uint32_t sym = 0;
+    if (!progressBegin(m_progress, JobProgress::Decoding, original)) return false;
+    uint64_t nextReport = kProgressBlock;
+    while (out.size() < original) {
+        if (out.size() >= nextReport) {
+            if (!progressAt(m_progress, out.size())) return false;
+            nextReport = out.size() + kProgressBlock;
+        }
+        if (!m_decoder.decodeSymbol(br, sym)) return false;
+        if (sym < 256) {
+            out.push_back((uint8_t)sym);
+            continue;
+        }
+        unsigned lc = sym - 256;
+        if (br.remaining() < runLengthExtra(lc)) return false;
+        uint32_t len = runLengthBase(lc) + br.read(runLengthExtra(lc));
+        if (!m_distDecoder.decodeSymbol(br, sym)) return false;
+        if (sym >= kDistCodeCount || br.remaining() < distanceExtra(sym)) return false;
+        uint32_t dist = distanceBase(sym) + br.read(distanceExtra(sym));
+        if (dist > out.size() || len > original - out.size()) return false;
+        // 距离可以小于长度（重叠复制），逐字节拷贝
+        size_t from = out.size() - dist;
+        for (uint32_t k = 0; k < len; ++k) out.push_back(out[from + k]);
+    }
+    if (br.remaining() != 0) return false;
+    p += bytes;
+    return true;
+}
+
+bool PhufCodec::encodeTokens(const std::string& utf8, std::vector<uint8_t>& out) {
+    writePhufHeader(out, PHUF_FLAG_TOKENS, utf8.size());
+    if (!utf8ToText(utf8, m_wtext)) return false;
+
+    tokenizeText(m_wtext.data(), m_wtext.size(), m_spans);
+    auto spanView = [this](const TextSpan& s) { return std::wstring_view(m_wtext.data() + s.start, s.length); };
+    m_tokenCounts.clear();
+    for (const TextSpan& s : m_spans) {
+        if (s.length > 1) ++m_tokenCounts[spanView(s)];
+    }
+
+    // 按节省的符号数（次数 × (长度 - 1)）挑选词表，同收益按字典序，保证输出确定
+    std::vector<std::pair<uint64_t, std::wstring_view>> ranked;
+    for (const auto& kv : m_tokenCounts) {
+        if (kv.second >= kMinTokenCount && kv.first.size() <= 0xFFFF) {
+            ranked.emplace_back((uint64_t)kv.second * (kv.first.size() - 1), kv.first);
+        }
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        if (a.first != b.first) return a.first > b.first;
+        return a.second < b.second;
+    });
+    if (ranked.size() > kMaxVocabulary) ranked.resize(kMaxVocabulary);
+    m_vocab.clear();
+    // 词频表的值改存词 id，未入选的词记为 UINT32_MAX，编码时按单字符回退
+    for (auto& kv : m_tokenCounts) kv.second = UINT32_MAX;
+    for (const auto& r : ranked) {
+        m_tokenCounts[r.second] = (uint32_t)m_vocab.size();
+        m_vocab.push_back(r.second);
+    }
+
+    // 按词块在原文中的位置汇报进度，被取消时返回 false
+    const uint32_t textAlphabet = HuffmanEncoder::kTextAlphabet;
+    auto forEachSymbol = [&](JobProgress::Phase phase, auto&& fn) {
+        if (!progressBegin(m_progress, phase, m_wtext.size())) return false;
+        size_t nextReport = kProgressBlock;
+        for (const TextSpan& s : m_spans) {
+            if (s.start >= nextReport) {
+                if (!progressAt(m_progress, s.start)) return false;
+                nextReport = s.start + kProgressBlock;
+            }
+            if (s.length > 1) {
+                uint32_t id = m_tokenCounts.find(spanView(s))->second;
+                if (id != UINT32_MAX) {
+                    fn(textAlphabet + id);
+                    continue;
+                }
+            }
+            for (uint32_t k = 0; k < s.length; ++k) fn((uint32_t)m_wtext[s.start + k]);
+        }
+        return true;
+    };
+
+    m_encoder.reset(textAlphabet + (uint32_t)m_vocab.size());
+    uint64_t symbols = 0;
+    bool counted = forEachSymbol(JobProgress::Analyzing, [&](uint32_t sym) {
+        m_encoder.count(sym);
+        ++symbols;
+    });
+    if (!counted) return false;
+    if (symbols > 0 && !m_encoder.buildCodes()) return false;
+
+    appendLE(out, m_vocab.size(), 4);
+    for (std::wstring_view w : m_vocab) {
+        appendLE(out, w.size(), 2);
+        for (wchar_t wc : w) appendLE(out, (uint16_t)wc, 2);
+    }
+    m_encoder.writeLengths(out);
+    appendLE(out, symbols, 8);
+    appendLE(out, m_encoder.encodedBits(), 8);
+    BitWriter bw(out);
+    if (!forEachSymbol(JobProgress::Encoding, [&](uint32_t sym) { m_encoder.put(sym, bw); })) return false;
+    bw.flush();
+    return true;
+}
+
+bool PhufCodec::decodeTokens(const uint8_t*& p, const uint8_t* end, uint64_t original, std::vector<uint8_t>& out) {
+    uint64_t vocabCount = 0;
+    if (!readLE(p, end, vocabCount, 4) || vocabCount > kMaxVocabulary) return false;
+    m_vocabText.resize((size_t)vocabCount);
+    for (std::wstring& w : m_vocabText) {
+        uint64_t len = 0, unit = 0;
+        if (!readLE(p, end, len, 2) || (uint64_t)(end - p) < len * 2) return false;
+        w.resize((size_t)len);
+        for (wchar_t& wc : w) {
+            readLE(p, end, unit, 2);
+            wc = (wchar_t)unit;
+        }
+    }
+
+    const uint32_t textAlphabet = HuffmanEncoder::kTextAlphabet;
+    uint64_t symbols = 0, bits = 0;
+    if (!m_decoder.readLengths(p, end, textAlphabet + (uint32_t)vocabCount)) return false;
+    if (!readLE(p, end, symbols, 8) || !readLE(p, end, bits, 8)) return false;
+    uint64_t bytes = (bits + 7) / 8;
+    if ((uint64_t)(end - p) < bytes || symbols > bits) return false;
+
+    m_wtext.clear();
+    BitReader br(p, bits);
+    uint32_t sym = 0;
+    if (!progressBegin(m_progress, JobProgress::Decoding, symbols)) return false;
+    for (uint64_t i = 0; i < symbols; ++i) {
+        if ((i & (kProgressBlock - 1)) == kProgressBlock - 1 && !progressAt(m_progress, i)) return false;
+        if (!m_decoder.decodeSymbol(br, sym)) return false;
+        if (sym < textAlphabet) {
+            m_wtext.push_back((wchar_t)sym);
+        } else {
+            m_wtext += m_vocabText[sym - textAlphabet];
+        }
+    }
+    if (br.remaining() != 0) return false;
+    p += bytes;
+    return textToUtf8(m_wtext, original, out);
+}
+
+bool PhufCodec::encodeContext(const std::string& utf8, std::vector<uint8_t>& out) {
+    writePhufHeader(out, PHUF_FLAG_CONTEXT, utf8.size());
+    if (!utf8ToText(utf8, m_wtext)) return false;
+    return m_context.encode(m_wtext, out);
+}
+
+bool PhufCodec::encodeTextMulti(const std::string& utf8, std::vector<uint8_t>& out) {
+    writePhufHeader(out, PHUF_FLAG_MULTI | PHUF_FLAG_TEXT, utf8.size());
+    if (!utf8ToText(utf8, m_wtext)) return false;
+    return m_multi.encode(m_wtext, out);
+}
+
+bool PhufCodec::decode(const uint8_t* data, size_t size, std::vector<uint8_t>& out, PhufImageInfo* info) {
+    out.clear();
+    if (!isPhuf(data, size)) return false;
+    const uint8_t* p = data + 4;
+    const uint8_t* end = data + size;
+    uint8_t version = *p++;
+    uint8_t flags = *p++;
+    p += 2;
+    uint64_t original = 0;
+    readLE(p, end, original, 8);
+    if (version != kPhufVersion) return false;
+    if (flags == PHUF_FLAG_LZ77) return decodeLz77(p, end, original, out);
+    if (flags == PHUF_FLAG_TOKENS) return decodeTokens(p, end, original, out);
+    if (flags == PHUF_FLAG_CONTEXT) return m_context.decode(p, end, m_wtext) && textToUtf8(m_wtext, original, out);
+    if (flags == (PHUF_FLAG_MULTI | PHUF_FLAG_TEXT)) return m_multi.decode(p, end, m_wtext) && textToUtf8(m_wtext, original, out);
+    if (flags & ~(PHUF_FLAG_PIXELS | PHUF_FLAG_PREDICT | PHUF_FLAG_RLE | PHUF_FLAG_MULTI)) return false;
+    if ((flags & PHUF_FLAG_RLE) && (flags & PHUF_FLAG_MULTI)) return false;
+
+    if (!(flags & PHUF_FLAG_PIXELS)) {
+        if (flags & PHUF_FLAG_PREDICT) return false;
+        if (!decodePayload(p, end, flags, out)) return false;
+        return out.size() == original;
+    }
+
+    uint64_t w = 0, h = 0, bpp = 0;
+    if (!readLE(p, end, w, 4) || !readLE(p, end, h, 4) || !readLE(p, end, bpp, 2)) return false;
+    PhufImageInfo img;
+    img.width = (int)w;
+    img.height = (int)h;
+    img.bitsPerPixel = (int)bpp;
+    if (!validImageInfo(img)) return false;
+    const int bytesPerPixel = img.bitsPerPixel / 8;
+    if ((uint64_t)img.width * img.height * bytesPerPixel != original) return false;
+
+    if (flags & PHUF_FLAG_PREDICT) {
+        m_filtered.clear();
+        if (!decodePayload(p, end, flags, m_filtered)) return false;
+        out.resize(original);
+        if (!unfilterImageRows(m_filtered.data(), m_filtered.size(), img.width, img.height, bytesPerPixel, out.data())) {
+            out.clear();
+            return false;
+        }
+    } else {
+        if (!decodePayload(p, end, flags, out)) return false;
+        if (out.size() != original) return false;
+    }
+    if (info) *info = img;
+    return true;
+}
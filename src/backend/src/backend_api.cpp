@@ -4,94 +4,231 @@
 #include <fstream>
 #include <iterator>
 #include <algorithm>
+#include <chrono>
 #include <unordered_map>
 #include <stdexcept>
 #include <ios>
 #include <functional>
 #include <cstdint>
+#include <cstdio>
 #include <windows.h>
 
 // 然后包含自定义头文件
 #include "EncodingUtils.h"
 #include "HuffmanTree.h"
+#include "HuffmanCodec.h"
+#include "PhufFormat.h"
 #include "backend_api.h"
 
-namespace backend_api {
+namespace {
+
+// 文件按块读写，块之间汇报进度、检查取消
+constexpr size_t kFileChunk = 1 << 20;
+
+// 调用期间把进度标记挂到线程内复用的编解码上下文上，返回时摘下
+template <typename Codec>
+class ProgressScope {
+public:
+    ProgressScope(Codec &codec, JobProgress *progress) : m_codec(codec) { m_codec.setProgress(progress); }
+    ~ProgressScope() { m_codec.setProgress(nullptr); }
+
+private:
+    Codec &m_codec;
+};
+
+// 读取整个文件到 out（std::string 或 std::vector<uint8_t>）
+template <typename Buffer>
+bool readWholeFile(const ::std::string &path, Buffer &out, JobProgress *progress) {
+    ::std::ifstream in(path, ::std::ios::binary | ::std::ios::ate);
+    if (!in.is_open()) return false;
+    ::std::streamoff size = in.tellg();
+    if (size < 0) return false;
+    in.seekg(0);
+    out.resize((size_t)size);
+    if (!progressBegin(progress, JobProgress::Reading, (uint64_t)size)) return false;
+    size_t done = 0;
+    while (done < out.size()) {
+        size_t n = ::std::min(out.size() - done, kFileChunk);
+        in.read(reinterpret_cast<char*>(&out[0]) + done, (::std::streamsize)n);
+        if ((size_t)in.gcount() != n) return false;
+        done += n;
+        if (!progressAt(progress, done)) return false;
+    }
+    return true;
+}
 
-::std::string encodeTextUtf8(const ::std::string &utf8_text)
-{
-    ::std::wstring wtext = ::utf8_to_wstring(utf8_text);
-    ::std::unordered_map<wchar_t, int> freqMap;
-    
-    for (wchar_t c : wtext)
-    {
-        freqMap[c]++;
+// 写出整个文件；失败或被取消时删除写了一半的文件
+bool writeWholeFile(const ::std::string &path, const void *data, size_t size, JobProgress *progress) {
+    ::std::ofstream out(path, ::std::ios::binary);
+    if (!out.is_open()) return false;
+    bool ok = progressBegin(progress, JobProgress::Writing, size);
+    const char *bytes = static_cast<const char*>(data);
+    for (size_t done = 0; ok && done < size;) {
+        size_t n = ::std::min(size - done, kFileChunk);
+        ok = (bool)out.write(bytes + done, (::std::streamsize)n);
+        done += n;
+        ok = ok && progressAt(progress, done);
     }
-    
-    ::std::vector<::std::pair<wchar_t, int>> freqVec(freqMap.begin(), freqMap.end());
-    HuffmanTree tree;
-    tree.buildForText(freqVec);
-    auto codeMap = tree.getCharCodeMap();
-    ::std::wstring bits = tree.encodeText(wtext, codeMap);
-    ::std::wstring table = tree.getSerializedCodeTable();
-    ::std::wstring combined = table + L"|" + bits;
-    
-    return ::wstring_to_utf8(combined);
+    out.close();
+    if (!ok || out.fail()) {
+        ::std::remove(path.c_str());
+        return false;
+    }
+    progressDone(progress);
+    return true;
 }
 
-::std::string decodeTextUtf8(const ::std::string &encoded_combined) {
-    ::std::wstring combined = ::utf8_to_wstring(encoded_combined);
+// 从 i 处解出一个 UTF-8 字符并前移 i；无效首字节或末尾被截断的多字节序列跳过一个字节并返回 false
+inline bool nextUtf8Char(const ::std::string &s, size_t &i, char32_t &ch) {
+    unsigned char c = (unsigned char)s[i];
+    size_t need = c < 0x80 ? 1 : c < 0xE0 ? 2 : c < 0xF0 ? 3 : c < 0xF8 ? 4 : 1;
+    if (need > s.size() - i) {
+        i++;
+        return false;
+    }
+    if (c < 0x80) { // 单字节（ASCII）
+        ch = c;
+        i++;
+    } else if (c < 0xE0) { // 双字节
+        ch = ((c & 0x1F) << 6) | (s[i+1] & 0x3F);
+        i += 2;
+    } else if (c < 0xF0) { // 三字节
+        ch = ((c & 0x0F) << 12) | ((s[i+1] & 0x3F) << 6) | (s[i+2] & 0x3F);
+        i += 3;
+    } else if (c < 0xF8) { // 四字节
+        ch = ((c & 0x07) << 18) | ((s[i+1] & 0x3F) << 12) | ((s[i+2] & 0x3F) << 6) | (s[i+3] & 0x3F);
+        i += 4;
+    } else { // 无效UTF-8，跳过
+        i++;
+        return false;
+    }
+    return true;
+}
 
-    size_t sep = ::std::wstring::npos;
-    for (size_t i = combined.size() - 1; i > 0; --i) {
-        if (combined[i] == L'|') {
-            bool isBits = true;
-            for (size_t j = i + 1; j < combined.size(); ++j) {
-                if (combined[j] != L'0' && combined[j] != L'1') {
-                    isBits = false;
-                    break;
-                }
-            }
-            if (isBits) {
-                sep = i;
-                break;
+// 统计可见字符、换行、制表符
+inline bool countedChar(char32_t ch) {
+    return ch >= 0x20 || ch == '\n' || ch == '\t';
+}
+
+} // namespace
+
+namespace backend_api {
+
+::std::string encodeTextUtf8(const ::std::string &utf8_text, CodecMode mode, HuffmanBuildTrace *trace,
+                             JobProgress *progress)
+{
+    if (trace) {
+        trace->leaves.clear();
+        trace->merges.clear();
+    }
+    // 每个线程复用一份编码上下文，频率表/码表/输出缓冲不再逐次分配
+    if (mode == CodecMode::Token || mode == CodecMode::Context || mode == CodecMode::MultiTable) {
+        thread_local PhufCodec codec;
+        thread_local ::std::vector<uint8_t> packed;
+        ProgressScope<PhufCodec> scope(codec, progress);
+        bool ok = mode == CodecMode::Token     ? codec.encodeTokens(utf8_text, packed)
+                  : mode == CodecMode::Context ? codec.encodeContext(utf8_text, packed)
+                                               : codec.encodeTextMulti(utf8_text, packed);
+        // 非法 UTF-8 或 BMP 以外的字符无法按字符建模，退回按字节编码，解码结果仍与原文逐字节相同
+        if (!ok) ok = codec.encode(reinterpret_cast<const uint8_t*>(utf8_text.data()), utf8_text.size(), packed,
+                                   PHUF_MODE_BYTES);
+        if (!ok) return ::std::string();
+        return ::std::string(reinterpret_cast<const char*>(packed.data()), packed.size());
+    }
+    thread_local HuffmanEncoder encoder;
+    ProgressScope<HuffmanEncoder> scope(encoder, progress);
+    const ::std::string &encoded = encoder.encodeTextUtf8(utf8_text, mode == CodecMode::RunLength);
+    if (trace && mode == CodecMode::Huffman && !encoded.empty()) {
+        // 建树记录直接取自刚才的编码器，与输出码表同源
+        for (uint32_t sym : encoder.mergeLeaves()) {
+            const HuffmanCode &c = encoder.code(sym);
+            ::std::string code(c.len, '0');
+            for (unsigned b = 0; b < c.len; ++b) {
+                if (c.bits >> (c.len - 1 - b) & 1) code[b] = '1';
             }
+            trace->leaves.push_back({wstring_to_utf8(::std::wstring(1, (wchar_t)sym)), encoder.frequency(sym), code});
+        }
+        for (const HuffmanEncoder::Merge &m : encoder.mergeSteps()) {
+            trace->merges.push_back({(int)m.left, (int)m.right, m.weight});
         }
     }
-
-    if (sep == ::std::wstring::npos) return ::std::string();
-    ::std::wstring table = combined.substr(0, sep);      // 错误应消失
-    ::std::wstring bits = combined.substr(sep + 1);      // 错误应消失
-
-    HuffmanTree tree;                                    // 需确保 HuffmanTree 类已定义
-    if (!tree.deserializeCodes(table)) return ::std::string();
-    ::std::wstring decoded = tree.decodeText(bits);
-    return wstring_to_utf8(decoded);                  // 修正函数名拼写
+    return encoded;
 }
 
-::std::string encodeImage(const ::std::vector<uint8_t> &image_data) {
-    // 统计频率
-    // 将uint8_t向量转换为BYTE向量
-    ::std::vector<BYTE> byte_data(image_data.begin(), image_data.end());
-    auto freqVec = ::getByteFrequencySorted(byte_data);
+::std::string decodeTextUtf8(const ::std::string &encoded_combined, JobProgress *progress) {
+    const uint8_t *raw = reinterpret_cast<const uint8_t*>(encoded_combined.data());
+    if (PhufCodec::isPhuf(raw, encoded_combined.size())) {
+        thread_local PhufCodec codec;
+        ProgressScope<PhufCodec> scope(codec, progress);
+        ::std::vector<uint8_t> bytes;
+        if (!codec.decode(raw, encoded_combined.size(), bytes)) return ::std::string();
+        return ::std::string(bytes.begin(), bytes.end());
+    }
+    thread_local HuffmanDecoder decoder;
+    ProgressScope<HuffmanDecoder> scope(decoder, progress);
+    ::std::string decoded;
+    if (!decoder.decodeTextUtf8(encoded_combined, decoded)) return ::std::string();
+    return decoded;
+}
 
-    // 构建哈夫曼树并编码
-    HuffmanTree tree;
-    tree.buildForImage(freqVec);
-    auto codeMap = tree.getByteCodeMap();
-    // 修复函数名冲突，使用不同的函数名
-    ::std::wstring bits = encodeImageData(byte_data, codeMap);
+::std::string encodeImage(const ::std::vector<uint8_t> &image_data, CodecMode mode, JobProgress *progress) {
+    // 直接按字节统计、建树并打包位流，输出 .phuf 二进制容器
+    thread_local PhufCodec codec;
+    thread_local ::std::vector<uint8_t> packed;
+    ProgressScope<PhufCodec> scope(codec, progress);
+    uint8_t flags = mode == CodecMode::RunLength    ? PHUF_FLAG_RLE
+                    : mode == CodecMode::MultiTable ? PHUF_FLAG_MULTI
+                                                    : PHUF_MODE_BYTES;
+    if (!codec.encode(image_data.data(), image_data.size(), packed, flags)) return ::std::string();
+    return ::std::string(reinterpret_cast<const char*>(packed.data()), packed.size());
+}
 
-    // 获取序列化编码表
-    ::std::wstring table = tree.getSerializedCodeTable();
+::std::string encodeImagePixels(const ::std::vector<uint8_t> &pixels, int width, int height,
+                                int bits_per_pixel, bool predict, CodecMode mode, JobProgress *progress) {
+    PhufImageInfo info;
+    info.width = width;
+    info.height = height;
+    info.bitsPerPixel = bits_per_pixel;
+    if (width < 0 || height < 0 || bits_per_pixel < 8 ||
+        pixels.size() != (size_t)width * height * (bits_per_pixel / 8)) return ::std::string();
+
+    thread_local PhufCodec codec;
+    thread_local ::std::vector<uint8_t> packed;
+    ProgressScope<PhufCodec> scope(codec, progress);
+    uint8_t flags = (predict ? PHUF_FLAG_PREDICT : 0) | (mode == CodecMode::RunLength ? PHUF_FLAG_RLE : 0) |
+                    (mode == CodecMode::MultiTable ? PHUF_FLAG_MULTI : 0);
+    if (!codec.encodePixels(pixels.data(), info, flags, packed)) return ::std::string();
+    return ::std::string(reinterpret_cast<const char*>(packed.data()), packed.size());
+}
 
-    // 合并为 <table>|<bits>
-    ::std::wstring combined = table + L"|" + bits;
-    return ::wstring_to_utf8(combined);
+::std::vector<uint8_t> decodeImagePixels(const ::std::string &encoded, int &width, int &height,
+                                         int &bits_per_pixel, JobProgress *progress) {
+    width = height = bits_per_pixel = 0;
+    const uint8_t *raw = reinterpret_cast<const uint8_t*>(encoded.data());
+    thread_local PhufCodec codec;
+    ProgressScope<PhufCodec> scope(codec, progress);
+    PhufImageInfo info;
+    ::std::vector<uint8_t> pixels;
+    if (!codec.decode(raw, encoded.size(), pixels, &info) || info.bitsPerPixel == 0) return {};
+    width = info.width;
+    height = info.height;
+    bits_per_pixel = info.bitsPerPixel;
+    return pixels;
 }
 
-::std::vector<uint8_t> decodeImage(const ::std::string &encoded_combined) {
+::std::vector<uint8_t> decodeImage(const ::std::string &encoded_combined, JobProgress *progress) {
+    const uint8_t *raw = reinterpret_cast<const uint8_t*>(encoded_combined.data());
+    if (PhufCodec::isPhuf(raw, encoded_combined.size())) {
+        thread_local PhufCodec codec;
+        ProgressScope<PhufCodec> scope(codec, progress);
+        ::std::vector<uint8_t> decoded;
+        if (!codec.decode(raw, encoded_combined.size(), decoded)) return {};
+        return decoded;
+    }
+
+    // 兼容旧版 <IMAGE|码表>|<01位串> 文本格式
     ::std::wstring combined = ::utf8_to_wstring(encoded_combined);
+    if (combined.empty()) return {};
     
     // 从后往前查找分隔符，确保编码表部分完整
     size_t sep = ::std::wstring::npos;
@@ -121,133 +258,100 @@ namespace backend_api {
     return tree.decodeImage(bits);
 }
 
-bool encodeTextFile(const ::std::string &input_file_path, const ::std::string &output_huf_path) {
+bool encodeTextFile(const ::std::string &input_file_path, const ::std::string &output_huf_path, int level,
+                    JobProgress *progress) {
     try {
         // 读取输入文件
-        ::std::ifstream input_file(input_file_path, ::std::ios::binary);
-        if (!input_file.is_open()) {
+        ::std::string utf8_text;
+        if (!readWholeFile(input_file_path, utf8_text, progress)) {
             return false;
         }
         
-        // 读取整个文件内容
-        ::std::string utf8_text((::std::istreambuf_iterator<char>(input_file)), ::std::istreambuf_iterator<char>());
-        input_file.close();
-        
-        // 编码文本
-        ::std::string encoded_data = encodeTextUtf8(utf8_text);
-        if (encoded_data.empty()) {
-            return false;
+        // 编码文本：LZ77 等级直接对 UTF-8 字节做匹配，重复的词组与整行都能被引用
+        ::std::string encoded_data;
+        if (level > 0) {
+            thread_local PhufCodec codec;
+            thread_local ::std::vector<uint8_t> packed;
+            ProgressScope<PhufCodec> scope(codec, progress);
+            if (!codec.encodeLz77(reinterpret_cast<const uint8_t*>(utf8_text.data()), utf8_text.size(), level, packed)) {
+                return false;
+            }
+            encoded_data.assign(reinterpret_cast<const char*>(packed.data()), packed.size());
+        } else {
+            encoded_data = encodeTextUtf8(utf8_text, CodecMode::Huffman, nullptr, progress);
         }
-        
-        // 写入.huf文件
-        ::std::ofstream output_file(output_huf_path, ::std::ios::binary);
-        if (!output_file.is_open()) {
+        if (encoded_data.empty() || (progress && progress->canceled())) {
             return false;
         }
         
-        output_file.write(encoded_data.c_str(), encoded_data.size());
-        output_file.close();
-        
-        return true;
+        // 写入.huf文件
+        return writeWholeFile(output_huf_path, encoded_data.data(), encoded_data.size(), progress);
     } catch (...) {
         return false;
     }
 }
 
-bool decodeTextFile(const ::std::string &input_huf_path, const ::std::string &output_file_path) {
+bool decodeTextFile(const ::std::string &input_huf_path, const ::std::string &output_file_path,
+                    JobProgress *progress) {
     try {
         // 读取.huf文件
-        ::std::ifstream input_file(input_huf_path, ::std::ios::binary);
-        if (!input_file.is_open()) {
+        ::std::string encoded_data;
+        if (!readWholeFile(input_huf_path, encoded_data, progress)) {
             return false;
         }
         
-        // 读取整个文件内容
-        ::std::string encoded_data((::std::istreambuf_iterator<char>(input_file)), ::std::istreambuf_iterator<char>());
-        input_file.close();
-        
         // 解码文本
-        ::std::string decoded_text = decodeTextUtf8(encoded_data);
+        ::std::string decoded_text = decodeTextUtf8(encoded_data, progress);
         if (decoded_text.empty()) {
             return false;
         }
         
         // 写入输出文件
-        ::std::ofstream output_file(output_file_path, ::std::ios::binary);
-        if (!output_file.is_open()) {
-            return false;
-        }
-        
-        output_file.write(decoded_text.c_str(), decoded_text.size());
-        output_file.close();
-        
-        return true;
+        return writeWholeFile(output_file_path, decoded_text.data(), decoded_text.size(), progress);
     } catch (...) {
         return false;
     }
 }
 
-bool encodeImageFile(const ::std::string &input_image_path, const ::std::string &output_huf_path) {
+bool encodeImageFile(const ::std::string &input_image_path, const ::std::string &output_huf_path,
+                     JobProgress *progress) {
     try {
         // 读取图片文件
-        ::std::ifstream input_file(input_image_path, ::std::ios::binary);
-        if (!input_file.is_open()) {
+        ::std::vector<uint8_t> image_data;
+        if (!readWholeFile(input_image_path, image_data, progress)) {
             return false;
         }
         
-        // 读取整个文件内容
-        ::std::vector<uint8_t> image_data((::std::istreambuf_iterator<char>(input_file)), ::std::istreambuf_iterator<char>());
-        input_file.close();
-        
         // 编码图片
-        ::std::string encoded_data = encodeImage(image_data);
+        ::std::string encoded_data = encodeImage(image_data, CodecMode::Huffman, progress);
         if (encoded_data.empty()) {
             return false;
         }
         
         // 写入.huf文件
-        ::std::ofstream output_file(output_huf_path, ::std::ios::binary);
-        if (!output_file.is_open()) {
-            return false;
-        }
-        
-        output_file.write(encoded_data.c_str(), encoded_data.size());
-        output_file.close();
-        
-        return true;
+        return writeWholeFile(output_huf_path, encoded_data.data(), encoded_data.size(), progress);
     } catch (...) {
         return false;
     }
 }
 
-bool decodeImageFile(const ::std::string &input_huf_path, const ::std::string &output_image_path) {
+bool decodeImageFile(const ::std::string &input_huf_path, const ::std::string &output_image_path,
+                     JobProgress *progress) {
     try {
         // 读取.huf文件
-        ::std::ifstream input_file(input_huf_path, ::std::ios::binary);
-        if (!input_file.is_open()) {
+        ::std::string encoded_data;
+        if (!readWholeFile(input_huf_path, encoded_data, progress)) {
             return false;
         }
         
-        // 读取整个文件内容
-        ::std::string encoded_data((::std::istreambuf_iterator<char>(input_file)), ::std::istreambuf_iterator<char>());
-        input_file.close();
-        
         // 解码图片
-        ::std::vector<uint8_t> decoded_image = decodeImage(encoded_data);
+        ::std::vector<uint8_t> decoded_image = decodeImage(encoded_data, progress);
         if (decoded_image.empty()) {
             return false;
         }
         
         // 写入图片文件
-        ::std::ofstream output_file(output_image_path, ::std::ios::binary);
-        if (!output_file.is_open()) {
-            return false;
-        }
-        
-        output_file.write(reinterpret_cast<const char*>(decoded_image.data()), decoded_image.size());
-        output_file.close();
-        
-        return true;
+        return writeWholeFile(output_image_path, decoded_image.data(), decoded_image.size(), progress);
     } catch (...) {
         return false;
     }
@@ -255,46 +359,30 @@ bool decodeImageFile(const ::std::string &input_huf_path, const ::std::string &o
 
 void streamTextFile(const ::std::string &file_path, 
                    const ::std::function<void(const ::std::unordered_map<char32_t, size_t> &)> &callback, 
-                   size_t batch_size) {
-    // 以二进制模式打开文件
-    ::std::ifstream file(file_path, ::std::ios::binary);
-    if (!file.is_open()) {
+                   size_t batch_size, JobProgress *progress) {
+    // 读取文件全部内容到string（UTF-8格式）
+    ::std::string utf8_str;
+    if (!readWholeFile(file_path, utf8_str, progress)) {
+        if (progress && progress->canceled()) return;
         throw ::std::runtime_error("无法打开文件：" + file_path);
     }
 
-    // 读取文件全部内容到string（UTF-8格式）
-    ::std::string utf8_str((::std::istreambuf_iterator<char>(file)), ::std::istreambuf_iterator<char>());
-    file.close();
-
     // 手动将UTF-8字符串转char32_t并统计频率
     ::std::unordered_map<char32_t, size_t> char_map;
     size_t i = 0;
     size_t processed = 0;
+    if (!progressBegin(progress, JobProgress::Analyzing, utf8_str.size())) return;
+    size_t nextReport = kProgressBlock;
 
     while (i < utf8_str.size()) {
-        char32_t ch = 0;
-        unsigned char c = (unsigned char)utf8_str[i];
-
-        // UTF-8解码规则
-        if (c < 0x80) { // 单字节（ASCII）
-            ch = c;
-            i++;
-        } else if (c < 0xE0) { // 双字节
-            ch = ((c & 0x1F) << 6) | (utf8_str[i+1] & 0x3F);
-            i += 2;
-        } else if (c < 0xF0) { // 三字节
-            ch = ((c & 0x0F) << 12) | ((utf8_str[i+1] & 0x3F) << 6) | (utf8_str[i+2] & 0x3F);
-            i += 3;
-        } else if (c < 0xF8) { // 四字节
-            ch = ((c & 0x07) << 18) | ((utf8_str[i+1] & 0x3F) << 12) | ((utf8_str[i+2] & 0x3F) << 6) | (utf8_str[i+3] & 0x3F);
-            i += 4;
-        } else { // 无效UTF-8，跳过
-            i++;
-            continue;
+        if (i >= nextReport) {
+            if (!progressAt(progress, i)) return;
+            nextReport = i + kProgressBlock;
         }
+        char32_t ch = 0;
+        if (!nextUtf8Char(utf8_str, i, ch)) continue;
 
-        // 统计可见字符、换行、制表符
-        if (ch >= 0x20 || ch == '\n' || ch == '\t') {
+        if (countedChar(ch)) {
             char_map[ch]++;
             processed++;
 
@@ -309,6 +397,90 @@ void streamTextFile(const ::std::string &file_path,
     if (processed > 0) {
         callback(char_map);
     }
+    progressDone(progress);
+}
+
+void streamTextFileDelta(const ::std::string &file_path,
+                         const ::std::function<void(const ::std::vector<SymbolCount> &delta)> &callback,
+                         ::std::chrono::milliseconds interval, JobProgress *progress) {
+    ::std::string utf8_str;
+    if (!readWholeFile(file_path, utf8_str, progress)) {
+        if (progress && progress->canceled()) return;
+        throw ::std::runtime_error("无法打开文件：" + file_path);
+    }
+
+    // 每个字符分配一个槽位：计数与“本轮已变化”标记放在数组里，
+    // 变化过的槽位记入 dirty，回调时只遍历它们
+    ::std::unordered_map<char32_t, uint32_t> slot_of;
+    ::std::vector<SymbolCount> counts;
+    ::std::vector<uint8_t> is_dirty;
+    ::std::vector<uint32_t> dirty;
+    ::std::vector<SymbolCount> delta;
+    // ASCII 直接查表，跳过哈希
+    uint32_t ascii_slot[128];
+    ::std::fill(ascii_slot, ascii_slot + 128, UINT32_MAX);
+
+    auto flush = [&]() {
+        if (dirty.empty()) return;
+        delta.clear();
+        for (uint32_t s : dirty) {
+            delta.push_back(counts[s]);
+            is_dirty[s] = 0;
+        }
+        dirty.clear();
+        callback(delta);
+    };
+
+    using Clock = ::std::chrono::steady_clock;
+    // 时钟每处理一块字节才读一次，热循环里不做系统调用
+    constexpr size_t kClockBlock = 4096;
+    auto next_flush = Clock::now() + interval;
+    size_t next_check = kClockBlock;
+    size_t next_report = kProgressBlock;
+    size_t i = 0;
+    if (!progressBegin(progress, JobProgress::Analyzing, utf8_str.size())) return;
+
+    while (i < utf8_str.size()) {
+        if (i >= next_check) {
+            next_check = i + kClockBlock;
+            if (i >= next_report) {
+                if (!progressAt(progress, i)) return;
+                next_report = i + kProgressBlock;
+            }
+            auto now = Clock::now();
+            if (now >= next_flush) {
+                flush();
+                next_flush = now + interval;
+            }
+        }
+        char32_t ch = 0;
+        if (!nextUtf8Char(utf8_str, i, ch) || !countedChar(ch)) continue;
+
+        uint32_t s;
+        if (ch < 128 && ascii_slot[ch] != UINT32_MAX) {
+            s = ascii_slot[ch];
+        } else {
+            auto it = slot_of.find(ch);
+            if (it == slot_of.end()) {
+                s = (uint32_t)counts.size();
+                slot_of.emplace(ch, s);
+                counts.push_back(SymbolCount{ch, 0});
+                is_dirty.push_back(0);
+                if (ch < 128) ascii_slot[ch] = s;
+            } else {
+                s = it->second;
+            }
+        }
+        counts[s].count++;
+        if (!is_dirty[s]) {
+            is_dirty[s] = 1;
+            dirty.push_back(s);
+        }
+    }
+
+    // 最后一轮变化
+    flush();
+    progressDone(progress);
 }
 
 #ifdef QT_CORE_LIB
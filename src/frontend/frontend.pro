@@ -9,12 +9,20 @@ SOURCES += \
     src/mainwindow.cpp \
     src/textencodedecodewindow.cpp \
     src/imageencodedecodewindow.cpp \
+    src/huffmanlayout.cpp \
+    src/huffmangraphics.cpp \
+    src/huffmananimator.cpp \
+    src/textencodejob.cpp \
 
 # 头文件路径（前端include目录下的所有头文件）
 HEADERS += \
     include/mainwindow.h \
     include/textencodedecodewindow.h \
     include/imageencodedecodewindow.h \
+    include/huffmanlayout.h \
+    include/huffmangraphics.h \
+    include/huffmananimator.h \
+    include/textencodejob.h \
     ../backend/include/backend_api.h \
 
 # 头文件搜索路径（告诉编译器去哪里找头文件）
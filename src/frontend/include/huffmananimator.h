@@ -0,0 +1,49 @@
+#pragma once
+#include <QEasingCurve>
+#include <QPointF>
+#include <QVector>
+
+class QTimeLine;
+class HuffmanNodeItem;
+class HuffmanEdgeItem;
+
+// 一步布局变化的节点动画：所有节点共用一条 QTimeLine，每帧按同一个进度插值。
+// 原来每个移动的节点各建一个 QVariantAnimation 放进 QParallelAnimationGroup，
+// 每步都要分配几千个动画对象，每帧触发几千次 valueChanged；
+// 这里轨迹数组跨步复用，每帧一次回调里移动全部节点，再把边图元标记失效一次。
+class HuffmanAnimator {
+public:
+    HuffmanAnimator();
+    ~HuffmanAnimator();
+    HuffmanAnimator(const HuffmanAnimator &) = delete;
+    HuffmanAnimator &operator=(const HuffmanAnimator &) = delete;
+
+    void setDuration(int msecs);
+    void setEasingCurve(const QEasingCurve &curve);
+    // 节点移动时需要重建路径的边图元，可为 nullptr
+    void setEdgeItem(HuffmanEdgeItem *edges) { m_edges = edges; }
+
+    // 停止当前动画（节点停在当前位置）并丢弃全部轨迹，开始登记新一步
+    void begin();
+    // 从当前位置/缩放移动到 to/toScale
+    void addMove(HuffmanNodeItem *item, const QPointF &to);
+    void addMove(HuffmanNodeItem *item, const QPointF &to, qreal toScale);
+    void start();
+    // 清空场景前调用：停止并丢弃所有图元指针
+    void clear();
+
+private:
+    struct Track {
+        HuffmanNodeItem *item;
+        QPointF from;
+        QPointF to;
+        qreal fromScale;
+        qreal toScale;
+    };
+
+    void apply(qreal progress);
+
+    QTimeLine *m_timeLine;
+    QVector<Track> m_tracks;
+    HuffmanEdgeItem *m_edges{nullptr};
+};
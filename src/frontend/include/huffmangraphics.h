@@ -0,0 +1,102 @@
+#pragma once
+#include <QBrush>
+#include <QGraphicsItem>
+#include <QPainterPath>
+#include <QString>
+#include <QVector>
+
+// 哈夫曼树可视化的自绘图元（带细节层次）
+// 原来每个节点是 QGraphicsItemGroup + 椭圆 + 两个文字项，每条边是曲线项 + 箭头项（+ 0/1 标签），
+// 几千个符号时场景里有上万个图元。这里每个节点只有一个图元，所有边由一个图元统一绘制，
+// 并按当前缩放（levelOfDetailFromTransform）决定画多少：
+//   - 缩放低于 kTextLod 不画文字，低于 kOutlineLod 只填充不描边、不画箭头；
+//   - 子树在屏幕上窄于 kCollapsePixels 时，子树根画成覆盖整棵子树的三角形，其后代与相连的边都不画。
+// 判断都在 paint 里就地完成，缩放时不需要遍历整棵树。
+// 折叠判断使用按 2^(1/4) 量化的缩放（collapseScale），节点与边得到一致的结果，
+// 边的批量路径也只在量化缩放变化时才需要重建。
+
+class HuffmanNodeItem : public QGraphicsItem {
+public:
+    enum { Type = UserType + 1 };
+
+    static constexpr qreal kRadius = 30;
+    static constexpr qreal kTextLod = 0.6;
+    static constexpr qreal kOutlineLod = 0.25;
+    static constexpr qreal kCollapsePixels = 24;
+
+    // label 为空表示内部节点（只显示权重）
+    HuffmanNodeItem(const QString &label, quint64 weight, QGraphicsItem *parent = nullptr);
+
+    int type() const override { return Type; }
+    QRectF boundingRect() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+    void setBrush(const QBrush &brush);
+    // 子树占据的矩形（图元坐标，相对节点中心），折叠时按它画聚合图形
+    void setSubtreeExtent(const QRectF &extent);
+    // 当前步的父节点；尚未合并时为 nullptr
+    void setParentNode(HuffmanNodeItem *parentNode) { m_parentNode = parentNode; }
+    HuffmanNodeItem *parentNode() const { return m_parentNode; }
+
+    // 把场景到屏幕的缩放量化为 2^(k/4)
+    static qreal collapseScale(qreal viewScale);
+    // viewScale 为 collapseScale 量化后的场景到屏幕缩放（不含本图元的 scale）
+    bool isCollapsedAt(qreal viewScale) const;
+    bool isHiddenAt(qreal viewScale) const {
+        return m_parentNode && m_parentNode->isCollapsedAt(viewScale);
+    }
+
+private:
+    QString m_label;
+    QString m_weightText;
+    QBrush m_brush;
+    QRectF m_extent;
+    HuffmanNodeItem *m_parentNode{nullptr};
+};
+
+// 所有边画在一个图元里：曲线合成一条 QPainterPath 描边，箭头合成一条 QPainterPath 填充，
+// 节点移动时只标记失效，下一次绘制时原地重建一次（clear() 保留容量），不再逐帧增删图元。
+class HuffmanEdgeItem : public QGraphicsItem {
+public:
+    HuffmanEdgeItem(QGraphicsItem *parent = nullptr);
+
+    QRectF boundingRect() const override { return m_bounds; }
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+    // 左边（0 分支）曲线的两个控制点：父节点位置 + parentControl、子节点位置 + childControl；
+    // 右边（1 分支）取 x 镜像。bitLabels 为 true 时在曲线中部标注 0/1
+    void setCurveStyle(const QPointF &parentControl, const QPointF &childControl, bool bitLabels);
+
+    void clear();
+    void addEdge(HuffmanNodeItem *parentNode, HuffmanNodeItem *child, bool right);
+    int edgeCount() const { return int(m_edges.size()); }
+    // 节点的活动范围（动画起止位置的并集）；包围盒只在这里改变
+    void setArea(const QRectF &area);
+    // 节点移动后调用：只做标记，路径留到下一次 paint 重建
+    void markDirty();
+
+private:
+    struct Edge {
+        HuffmanNodeItem *parentNode;
+        HuffmanNodeItem *child;
+        bool right;
+    };
+    struct Label {
+        QPointF pos;
+        bool right;
+    };
+
+    void rebuildPaths(qreal viewScale);
+
+    QVector<Edge> m_edges;
+    QRectF m_bounds;
+    QPointF m_parentControl{0, 40};
+    QPointF m_childControl{0, -40};
+    bool m_bitLabels{false};
+
+    QPainterPath m_curves;
+    QPainterPath m_arrows;
+    QVector<Label> m_labels;
+    qreal m_pathScale{-1};  // 路径按哪个量化缩放构建
+    bool m_dirty{true};
+};
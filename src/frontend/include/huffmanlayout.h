@@ -0,0 +1,59 @@
+#pragma once
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+#include <climits>
+
+// 哈夫曼森林的增量布局
+// 一棵子树合并之后形状不再改变，所以每个节点只在创建时算一次"相对布局"：
+// 子树宽度、节点中心相对子树左边界的偏移、自身左边界相对父节点左边界的偏移。
+// 任意步数下的绝对坐标只需 O(n) 扫描一遍：
+//   森林中的树按根 id 升序从左到右排列（叶子按输入顺序，合并出的父节点依次追加在后面，
+//   与旧实现每步 removeAt + append 得到的顺序一致）；父节点 id 总大于子节点，
+//   按 id 降序即可由父节点推出子节点位置，不需要递归，也不会因树很深而爆栈。
+// demo_huffman（根目录的 HuffmanWidget）与前端 TextEncodeDecodeWindow 共用。
+class HuffmanLayout {
+public:
+    static constexpr double kLeafWidth = 60;
+    static constexpr double kSpacing = 20;
+
+    // 清空并放入 leafCount 个叶子（id 0..leafCount-1）
+    void reset(int leafCount);
+    // 追加一步合并：parent 必须等于当前的 nodeCount()；O(1)
+    bool addMerge(int a, int b, int parent);
+
+    int leafCount() const { return m_leafCount; }
+    int nodeCount() const { return int(m_nodes.size()); }
+    int stepCount() const { return nodeCount() - m_leafCount; }
+
+    // 子树宽度（含全部后代）
+    double width(int id) const { return m_nodes[id].width; }
+    // 子树占据的矩形，相对节点中心；levelStep 与 place() 的含义相同
+    QRectF subtreeRect(int id, double levelStep) const;
+    // 执行 stepsDone 步之后的父节点，尚未合并时为 -1
+    int parentAt(int id, int stepsDone) const {
+        const Node &n = m_nodes[id];
+        return n.mergedAt < stepsDone ? n.parent : -1;
+    }
+
+    // 执行 stepsDone 步之后整片森林的宽度（各棵树之间留 kSpacing）
+    double forestWidth(int stepsDone) const;
+    // 执行 stepsDone 步之后前 leafCount + stepsDone 个节点的中心坐标：
+    // 森林左边界为 left，根所在行 y = top，每往下一层 y 增加 levelStep（可为负）
+    void place(int stepsDone, double left, double top, double levelStep, QVector<QPointF> &out) const;
+
+private:
+    struct Node {
+        int parent{-1};
+        int mergedAt{INT_MAX};  // 被合并进父节点的步序号
+        double width{kLeafWidth};
+        double center{kLeafWidth / 2};  // 节点中心相对自身子树左边界
+        double offset{0};               // 自身子树左边界相对父节点子树左边界
+        int levels{0};                  // 子树高度（叶子为 0）
+    };
+
+    int visibleCount(int stepsDone) const;
+
+    QVector<Node> m_nodes;
+    int m_leafCount{0};
+};
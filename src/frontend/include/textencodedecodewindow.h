@@ -8,46 +8,21 @@
 #include <QHBoxLayout>
 #include <QGroupBox>
 #include <QPlainTextEdit>
+#include <QProgressDialog>
 #include <QFile>
 #include <QGraphicsView>
 #include <QGraphicsScene>
 #include <QGraphicsItem>
-#include <QAbstractAnimation>
 #include <QSlider>
 #include <QTimer>
 #include <QMap>
 #include <QPair>
-#include <QSharedPointer>
 #include <functional>
-
-// Huffman树相关结构体和类
-struct HuffNode {
-    int weight;
-    QString label; // for leaves
-    QSharedPointer<HuffNode> left;
-    QSharedPointer<HuffNode> right;
-    int id;
-    HuffNode(int w = 0, const QString &l = QString(), int _id = -1)
-        : weight(w), label(l), left(nullptr), right(nullptr), id(_id) {}
-};
-
-struct HuffStep {
-    QSharedPointer<HuffNode> a;
-    QSharedPointer<HuffNode> b;
-    QSharedPointer<HuffNode> parent;
-};
-
-class HuffmanBuilder {
-public:
-    // input: vector of (label, weight)
-    explicit HuffmanBuilder(const QVector<QPair<QString,int>>& items);
-
-    // generate steps of combining two smallest nodes until one root remains
-    QVector<HuffStep> buildSteps();
-
-private:
-    QVector<QPair<QString,int>> m_items;
-};
+#include "huffmanlayout.h"
+#include "huffmangraphics.h"
+#include "huffmananimator.h"
+#include "backend_api.h"
+#include "textencodejob.h"
 
 class TextEncodeDecodeWindow : public QMainWindow {
     Q_OBJECT
@@ -61,6 +36,7 @@ private slots:
     void onEncodeTextClicked();
     void onBrowseTextFileClicked();
     void onEncodeTextFileClicked();
+    void onEncodeTextFileFinished();
     void onExportTextHufClicked();
     
     // 解码相关
@@ -74,15 +50,17 @@ private slots:
     void onHuffmanReset();
     void onHuffmanZoomChanged(int value);
     void autoplayHuffmanStep();
+    void onHuffmanSeek(int step);
 
 private:
     void initUI();
     void initHuffmanVisualization();
     void prepareHuffmanNodes();
-    void performHuffmanStep(const HuffStep &step);
-    void layoutAndAnimateHuffman(int stepsDone);
+    void seekHuffmanStep(int step, bool animate);
+    void layoutAndAnimateHuffman(int stepsDone, bool animate);
     void clearHuffmanEdges();
     void drawHuffmanEdges(int stepsDone);
+    int huffmanStepCount() const { return int(m_huffmanTrace.merges.size()); }
     
     // 编码部分组件
     QGroupBox *encodeGroupBox;
@@ -105,6 +83,10 @@ private:
     // 当前编码结果
     std::string currentEncodedText;
     
+    // 后台文件编码任务（同一时间至多一个）
+    TextEncodeJob *m_encodeJob{nullptr};
+    QProgressDialog *m_encodeProgress{nullptr};
+    
     // 哈夫曼树可视化相关
     QGraphicsView *m_huffmanView{nullptr};
     QGraphicsScene *m_huffmanScene{nullptr};
@@ -113,14 +95,15 @@ private:
     QPushButton *m_resetBtn{nullptr};
     QTimer *m_huffmanTimer{nullptr};
     QSlider *m_zoomSlider{nullptr};
+    QSlider *m_stepSlider{nullptr};
+    QLabel *m_stepLabel{nullptr};
     
-    QVector<QPair<QString, int>> m_huffmanItems;
-    QVector<HuffStep> m_huffmanSteps;
+    // 最近一次编码的建树过程（后端给出的叶子与合并序列）
+    backend_api::HuffmanBuildTrace m_huffmanTrace;
     int m_currentHuffmanStep{0};
-    QMap<int, QGraphicsItem*> m_huffmanItemMap;
-    QVector<QGraphicsItem*> m_huffmanEdgeItems;
-    QVector<QAbstractAnimation*> m_activeAnims;
-    
-    // 字符频率统计
-    QMap<QChar, int> m_characterFrequency;
+    HuffmanLayout m_huffmanLayout;
+    QVector<QPointF> m_huffmanPositions;
+    QVector<HuffmanNodeItem*> m_huffmanNodeItems;  // 节点 id -> 图元
+    HuffmanEdgeItem *m_huffmanEdgeItem{nullptr};
+    HuffmanAnimator m_huffmanAnimator;
 };
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+#include <QString>
+#include <QThread>
+#include <string>
+#include "backend_api.h"
+#include "JobProgress.h"
+
+// 在后台线程里读取并编码一个文本文件
+// 原来 onEncodeTextFileClicked 在界面线程上 readAll + encodeTextUtf8，大文件时窗口卡死。
+// 任务只在工作线程里读写自己的成员，结束时发出 QThread::finished，界面再读取结果。
+// 进度与取消走后端的 JobProgress：界面定时读取 percent()/phaseText()，
+// cancel() 可在任意线程调用，读文件和编码时每处理一块检查一次。
+class TextEncodeJob : public QThread {
+    Q_OBJECT
+
+public:
+    explicit TextEncodeJob(const QString &filePath, QObject *parent = nullptr);
+
+    void cancel() { m_progress.requestCancel(); }
+    bool isCanceled() const { return m_progress.canceled(); }
+
+    // 总进度 0..100：读文件 0-30，统计频率 30-50，写位流 50-100
+    int percent() const;
+    QString phaseText() const;
+
+    // 以下结果在 finished 之后读取
+    bool succeeded() const { return m_succeeded; }
+    const QString &errorString() const { return m_error; }
+    const QString &filePath() const { return m_filePath; }
+    qint64 originalSize() const { return m_originalSize; }
+    const std::string &encoded() const { return m_encoded; }
+    backend_api::HuffmanBuildTrace &trace() { return m_trace; }
+
+protected:
+    void run() override;
+
+private:
+    QString m_filePath;
+    JobProgress m_progress;
+
+    bool m_succeeded{false};
+    QString m_error;
+    qint64 m_originalSize{0};
+    std::string m_encoded;
+    backend_api::HuffmanBuildTrace m_trace;
+};
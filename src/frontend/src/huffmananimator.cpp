@@ -0,0 +1,66 @@
+#include "huffmananimator.h"
+#include "huffmangraphics.h"
+#include <QTimeLine>
+
+HuffmanAnimator::HuffmanAnimator()
+    : m_timeLine(new QTimeLine(500))
+{
+    // QTimeLine 默认 40ms 一帧，改为约 60 帧/秒，与原 QVariantAnimation 一致
+    m_timeLine->setUpdateInterval(16);
+    m_timeLine->setEasingCurve(QEasingCurve::Linear);
+    QObject::connect(m_timeLine, &QTimeLine::valueChanged, m_timeLine, [this](qreal v) { apply(v); });
+    QObject::connect(m_timeLine, &QTimeLine::finished, m_timeLine, [this]() { apply(1.0); });
+}
+
+HuffmanAnimator::~HuffmanAnimator()
+{
+    delete m_timeLine;
+}
+
+void HuffmanAnimator::setDuration(int msecs)
+{
+    m_timeLine->setDuration(msecs);
+}
+
+void HuffmanAnimator::setEasingCurve(const QEasingCurve &curve)
+{
+    m_timeLine->setEasingCurve(curve);
+}
+
+void HuffmanAnimator::begin()
+{
+    m_timeLine->stop();
+    // resize(0) 保留容量，之后每一步不再分配
+    m_tracks.resize(0);
+}
+
+void HuffmanAnimator::addMove(HuffmanNodeItem *item, const QPointF &to)
+{
+    addMove(item, to, item->scale());
+}
+
+void HuffmanAnimator::addMove(HuffmanNodeItem *item, const QPointF &to, qreal toScale)
+{
+    m_tracks.append(Track{item, item->pos(), to, item->scale(), toScale});
+}
+
+void HuffmanAnimator::start()
+{
+    if (m_tracks.isEmpty()) return;
+    m_timeLine->start();
+}
+
+void HuffmanAnimator::clear()
+{
+    begin();
+    m_edges = nullptr;
+}
+
+void HuffmanAnimator::apply(qreal progress)
+{
+    for (const Track &t : m_tracks) {
+        t.item->setPos(t.from + (t.to - t.from) * progress);
+        if (t.fromScale != t.toScale) t.item->setScale(t.fromScale + (t.toScale - t.fromScale) * progress);
+    }
+    if (m_edges) m_edges->markDirty();
+}
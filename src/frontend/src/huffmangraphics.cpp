@@ -0,0 +1,186 @@
+#include "huffmangraphics.h"
+#include <QPainter>
+#include <QPolygonF>
+#include <QStyleOptionGraphicsItem>
+#include <cmath>
+
+namespace {
+
+const QRectF kNodeRect(-HuffmanNodeItem::kRadius, -HuffmanNodeItem::kRadius,
+                       2 * HuffmanNodeItem::kRadius, 2 * HuffmanNodeItem::kRadius);
+
+// 曲线终点处的箭头（三角形），追加到 path；from 为曲线最后一个控制点
+void addArrowHead(QPainterPath &path, const QPointF &end, const QPointF &from)
+{
+    QPointF dir = end - from;
+    double len = std::hypot(dir.x(), dir.y());
+    if (len <= 0.1) return;
+    dir /= len;
+    path.moveTo(end);
+    path.lineTo(end - dir * 12 + QPointF(-dir.y() * 6, dir.x() * 6));
+    path.lineTo(end - dir * 12 + QPointF(dir.y() * 6, -dir.x() * 6));
+    path.closeSubpath();
+}
+
+} // namespace
+
+HuffmanNodeItem::HuffmanNodeItem(const QString &label, quint64 weight, QGraphicsItem *parent)
+    : QGraphicsItem(parent), m_label(label), m_weightText(QString::number(weight)),
+      m_brush(QColor(100, 150, 240)), m_extent(kNodeRect)
+{
+}
+
+QRectF HuffmanNodeItem::boundingRect() const
+{
+    return kNodeRect.united(m_extent).adjusted(-1, -1, 1, 1);
+}
+
+void HuffmanNodeItem::setBrush(const QBrush &brush)
+{
+    m_brush = brush;
+    update();
+}
+
+void HuffmanNodeItem::setSubtreeExtent(const QRectF &extent)
+{
+    if (extent == m_extent) return;
+    prepareGeometryChange();
+    m_extent = extent;
+}
+
+qreal HuffmanNodeItem::collapseScale(qreal viewScale)
+{
+    if (viewScale <= 0) return viewScale;
+    return std::exp2(std::floor(std::log2(viewScale) * 4) / 4);
+}
+
+bool HuffmanNodeItem::isCollapsedAt(qreal viewScale) const
+{
+    // 叶子的 extent 就是自身圆形，不会折叠
+    return m_label.isEmpty() && m_extent.width() * scale() * viewScale < kCollapsePixels;
+}
+
+void HuffmanNodeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    const qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    const qreal viewScale = collapseScale(scale() > 0 ? lod / scale() : lod);
+    if (isHiddenAt(viewScale)) return;
+
+    if (isCollapsedAt(viewScale)) {
+        // 聚合图形：顶点在本节点，底边覆盖子树最远一层
+        const qreal farY = m_extent.top() < 0 ? m_extent.top() : m_extent.bottom();
+        QPolygonF tri;
+        tri << QPointF(0, 0) << QPointF(m_extent.left(), farY) << QPointF(m_extent.right(), farY);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(m_brush);
+        painter->drawPolygon(tri);
+        return;
+    }
+
+    if (lod < kOutlineLod) {
+        painter->fillRect(kNodeRect, m_brush);
+        return;
+    }
+    painter->setPen(QPen(Qt::black));
+    painter->setBrush(m_brush);
+    painter->drawEllipse(kNodeRect);
+    if (lod < kTextLod) return;
+
+    if (m_label.isEmpty()) {
+        painter->drawText(kNodeRect, Qt::AlignCenter, m_weightText);
+    } else {
+        QRectF upper(kNodeRect.left(), kNodeRect.top(), kNodeRect.width(), kRadius);
+        QRectF lower(kNodeRect.left(), 0, kNodeRect.width(), kRadius);
+        painter->setPen(Qt::white);
+        painter->drawText(upper, Qt::AlignHCenter | Qt::AlignBottom, m_label);
+        painter->setPen(Qt::black);
+        painter->drawText(lower, Qt::AlignHCenter | Qt::AlignTop, m_weightText);
+    }
+}
+
+HuffmanEdgeItem::HuffmanEdgeItem(QGraphicsItem *parent)
+    : QGraphicsItem(parent)
+{
+    setZValue(-1);
+}
+
+void HuffmanEdgeItem::setCurveStyle(const QPointF &parentControl, const QPointF &childControl, bool bitLabels)
+{
+    m_parentControl = parentControl;
+    m_childControl = childControl;
+    m_bitLabels = bitLabels;
+    update();
+}
+
+void HuffmanEdgeItem::clear()
+{
+    m_edges.clear();
+    markDirty();
+}
+
+void HuffmanEdgeItem::addEdge(HuffmanNodeItem *parentNode, HuffmanNodeItem *child, bool right)
+{
+    m_edges.append(Edge{parentNode, child, right});
+    markDirty();
+}
+
+void HuffmanEdgeItem::setArea(const QRectF &area)
+{
+    // 控制点、箭头与标签会超出节点中心的范围
+    qreal margin = qMax(std::abs(m_parentControl.y()), std::abs(m_childControl.y())) + HuffmanNodeItem::kRadius;
+    QRectF bounds = area.adjusted(-margin, -margin, margin, margin);
+    if (bounds != m_bounds) {
+        prepareGeometryChange();
+        m_bounds = bounds;
+    }
+    markDirty();
+}
+
+void HuffmanEdgeItem::markDirty()
+{
+    m_dirty = true;
+    update();
+}
+
+void HuffmanEdgeItem::rebuildPaths(qreal viewScale)
+{
+    m_curves.clear();
+    m_arrows.clear();
+    m_labels.clear();
+    for (const Edge &e : m_edges) {
+        // 子节点落在折叠的子树里时，这条边也被聚合图形代替
+        if (e.child->isHiddenAt(viewScale)) continue;
+        const QPointF start = e.parentNode->pos();
+        const QPointF end = e.child->pos();
+        const qreal mirror = e.right ? -1 : 1;
+        const QPointF c1 = start + QPointF(m_parentControl.x() * mirror, m_parentControl.y());
+        const QPointF c2 = end + QPointF(m_childControl.x() * mirror, m_childControl.y());
+
+        m_curves.moveTo(start);
+        m_curves.cubicTo(c1, c2, end);
+        addArrowHead(m_arrows, end, c2);
+        if (m_bitLabels) m_labels.append(Label{(c1 + c2) / 2, e.right});
+    }
+    m_pathScale = viewScale;
+    m_dirty = false;
+}
+
+void HuffmanEdgeItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
+{
+    const qreal lod = option->levelOfDetailFromTransform(painter->worldTransform());
+    const qreal viewScale = HuffmanNodeItem::collapseScale(lod);
+    if (m_dirty || viewScale != m_pathScale) rebuildPaths(viewScale);
+
+    const bool detailed = lod >= HuffmanNodeItem::kOutlineLod;
+    QPen pen(Qt::black, 2);
+    if (!detailed) pen.setCosmetic(true);
+    painter->strokePath(m_curves, pen);
+    if (!detailed) return;
+    painter->fillPath(m_arrows, Qt::black);
+
+    if (lod < HuffmanNodeItem::kTextLod) return;
+    painter->setPen(Qt::red);
+    for (const Label &l : m_labels) {
+        painter->drawText(QPointF(l.pos.x() - 5, l.pos.y() + 5), l.right ? QStringLiteral("1") : QStringLiteral("0"));
+    }
+}
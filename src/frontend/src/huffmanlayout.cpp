@@ -0,0 +1,79 @@
+#include "huffmanlayout.h"
+
+void HuffmanLayout::reset(int leafCount)
+{
+    m_leafCount = qMax(leafCount, 0);
+    m_nodes.clear();
+    m_nodes.resize(m_leafCount);
+}
+
+bool HuffmanLayout::addMerge(int a, int b, int parent)
+{
+    const int count = int(m_nodes.size());
+    if (parent != count || a < 0 || b < 0 || a >= count || b >= count || a == b) return false;
+    if (m_nodes[a].parent >= 0 || m_nodes[b].parent >= 0) return false;
+
+    const int step = count - m_leafCount;
+    Node &left = m_nodes[a];
+    Node &right = m_nodes[b];
+    left.parent = parent;
+    left.mergedAt = step;
+    left.offset = 0;
+    right.parent = parent;
+    right.mergedAt = step;
+    right.offset = left.width + kSpacing;
+
+    Node p;
+    p.width = left.width + right.width + kSpacing;
+    // 父节点位于两个子节点中心的正中
+    p.center = (left.center + right.offset + right.center) / 2.0;
+    p.levels = qMax(left.levels, right.levels) + 1;
+    m_nodes.append(p);
+    return true;
+}
+
+QRectF HuffmanLayout::subtreeRect(int id, double levelStep) const
+{
+    const Node &n = m_nodes[id];
+    return QRectF(-n.center, 0, n.width, n.levels * levelStep).normalized();
+}
+
+int HuffmanLayout::visibleCount(int stepsDone) const
+{
+    return qBound(m_leafCount, m_leafCount + stepsDone, int(m_nodes.size()));
+}
+
+double HuffmanLayout::forestWidth(int stepsDone) const
+{
+    double total = 0;
+    const int count = visibleCount(stepsDone);
+    for (int id = 0; id < count; ++id) {
+        if (m_nodes[id].mergedAt >= stepsDone) total += m_nodes[id].width + kSpacing;
+    }
+    return total;
+}
+
+void HuffmanLayout::place(int stepsDone, double left, double top, double levelStep, QVector<QPointF> &out) const
+{
+    const int count = visibleCount(stepsDone);
+    out.resize(count);
+
+    // 第一遍：根按 id 升序从左到右排开；out 暂存 (子树左边界, 层数)
+    double cursor = left;
+    for (int id = 0; id < count; ++id) {
+        const Node &n = m_nodes[id];
+        if (n.mergedAt < stepsDone) continue;
+        out[id] = QPointF(cursor, 0);
+        cursor += n.width + kSpacing;
+    }
+    // 第二遍：父节点 id 大于子节点，降序扫描时父节点的左边界已经确定
+    for (int id = count - 1; id >= 0; --id) {
+        const Node &n = m_nodes[id];
+        if (n.mergedAt >= stepsDone) continue;
+        const QPointF &p = out[n.parent];
+        out[id] = QPointF(p.x() + n.offset, p.y() + 1);
+    }
+    for (int id = 0; id < count; ++id) {
+        out[id] = QPointF(out[id].x() + m_nodes[id].center, top + out[id].y() * levelStep);
+    }
+}
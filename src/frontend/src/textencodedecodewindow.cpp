@@ -2,15 +2,12 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QBuffer>
-#include <QPainterPath>
-#include <QGraphicsPathItem>
-#include <QPolygonF>
-#include <QParallelAnimationGroup>
-#include <QVariantAnimation>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QWheelEvent>
+#include <QLinearGradient>
+#include <QSignalBlocker>
 #include <algorithm>
 #include "backend_api.h"
 
@@ -22,6 +19,8 @@ public:
         setDragMode(QGraphicsView::ScrollHandDrag);
         setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
         setResizeAnchor(QGraphicsView::AnchorUnderMouse);
+        // 节点与边图元每次绘制都自己设置画笔画刷，省去逐图元的 save/restore
+        setOptimizationFlag(QGraphicsView::DontSavePainterState);
     }
 protected:
     void wheelEvent(QWheelEvent *event) override {
@@ -36,55 +35,17 @@ protected:
     }
 };
 
-// HuffmanBuilder类成员函数实现
-HuffmanBuilder::HuffmanBuilder(const QVector<QPair<QString,int>>& items)
-    : m_items(items)
-{
-}
-
-QVector<HuffStep> HuffmanBuilder::buildSteps()
-{
-    QVector<HuffStep> steps;
-    // create initial nodes
-    QVector<QSharedPointer<HuffNode>> pool;
-    int nextId = 0;
-    for (const auto &p : m_items) {
-        auto node = QSharedPointer<HuffNode>::create(p.second, p.first, nextId++);
-        pool.append(node);
-    }
-
-    // use simple greedy algorithm
-    while (pool.size() > 1) {
-        // sort ascending by weight, tie-break by id
-        std::sort(pool.begin(), pool.end(), [](const QSharedPointer<HuffNode>& n1, const QSharedPointer<HuffNode>& n2){
-            if (n1->weight != n2->weight) return n1->weight < n2->weight;
-            return n1->id < n2->id;
-        });
-
-        auto a = pool.takeFirst();
-        auto b = pool.takeFirst();
-        auto parent = QSharedPointer<HuffNode>::create(a->weight + b->weight, QString(), nextId++);
-        parent->left = a;
-        parent->right = b;
-
-        HuffStep s;
-        s.a = a;
-        s.b = b;
-        s.parent = parent;
-        steps.append(s);
-
-        pool.append(parent);
-    }
-
-    return steps;
-}
-
 TextEncodeDecodeWindow::TextEncodeDecodeWindow(QWidget *parent)
     : QMainWindow(parent) {
     initUI();
 }
 
 TextEncodeDecodeWindow::~TextEncodeDecodeWindow() {
+    // QThread 对象不能在线程仍在运行时析构
+    if (m_encodeJob) {
+        m_encodeJob->cancel();
+        m_encodeJob->wait();
+    }
 }
 
 void TextEncodeDecodeWindow::initUI() {
@@ -208,6 +169,8 @@ void TextEncodeDecodeWindow::initHuffmanVisualization() {
     m_huffmanView = new ZoomView(this);
     m_huffmanScene = new QGraphicsScene(this);
     m_huffmanScene->setSceneRect(-1000, -1000, 2000, 2000);
+    // 每一步所有节点都在移动，BSP 索引只会被反复重建
+    m_huffmanScene->setItemIndexMethod(QGraphicsScene::NoIndex);
     m_huffmanView->setScene(m_huffmanScene);
     
     // 创建控制按钮
@@ -216,6 +179,14 @@ void TextEncodeDecodeWindow::initHuffmanVisualization() {
     m_playBtn = new QPushButton("Play");
     m_resetBtn = new QPushButton("Reset");
     m_huffmanTimer = new QTimer(this);
+    m_huffmanAnimator.setDuration(500);
+    m_huffmanAnimator.setEasingCurve(QEasingCurve::OutCubic);
+    
+    // 拖动到任意一步；节点图元预先全部创建，任意步的状态可直接由布局推出
+    m_stepSlider = new QSlider(Qt::Horizontal);
+    m_stepSlider->setRange(0, 0);
+    m_stepSlider->setToolTip("步骤");
+    m_stepLabel = new QLabel("0 / 0");
     
     m_zoomSlider = new QSlider(Qt::Horizontal);
     m_zoomSlider->setRange(10, 200);
@@ -225,6 +196,9 @@ void TextEncodeDecodeWindow::initHuffmanVisualization() {
     controlLayout->addWidget(m_stepBtn);
     controlLayout->addWidget(m_playBtn);
     controlLayout->addWidget(m_resetBtn);
+    controlLayout->addWidget(new QLabel("步骤："));
+    controlLayout->addWidget(m_stepSlider, 1);
+    controlLayout->addWidget(m_stepLabel);
     controlLayout->addStretch(1);
     controlLayout->addWidget(new QLabel("缩放："));
     controlLayout->addWidget(m_zoomSlider);
@@ -235,6 +209,7 @@ void TextEncodeDecodeWindow::initHuffmanVisualization() {
     connect(m_resetBtn, &QPushButton::clicked, this, &TextEncodeDecodeWindow::onHuffmanReset);
     connect(m_huffmanTimer, &QTimer::timeout, this, &TextEncodeDecodeWindow::autoplayHuffmanStep);
     connect(m_zoomSlider, &QSlider::valueChanged, this, &TextEncodeDecodeWindow::onHuffmanZoomChanged);
+    connect(m_stepSlider, &QSlider::valueChanged, this, &TextEncodeDecodeWindow::onHuffmanSeek);
     
     // 将组件添加到布局
     huffmanLayout->addLayout(controlLayout);
@@ -252,14 +227,9 @@ void TextEncodeDecodeWindow::onEncodeTextClicked() {
         return;
     }
     
-    // 统计字符频率
-    m_characterFrequency.clear();
-    for (QChar c : text) {
-        m_characterFrequency[c]++;
-    }
-    
-    // 调用后端API进行编码
-    std::string encodedData = backend_api::encodeTextUtf8(text.toStdString());
+    // 调用后端API进行编码，同时取回建树过程用于可视化（不再单独统计字符频率）
+    std::string encodedData = backend_api::encodeTextUtf8(text.toStdString(), backend_api::CodecMode::Huffman,
+                                                          &m_huffmanTrace);
 if (!encodedData.empty()) {
     encodeResultEdit->setPlainText(QString::fromStdString(encodedData));
     currentEncodedText = encodedData;
@@ -322,33 +292,57 @@ void TextEncodeDecodeWindow::onEncodeTextFileClicked() {
         return;
     }
     
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "警告", "无法打开文件！");
+    if (m_encodeJob) return;
+    
+    // 读文件与编码放到后台线程，界面只显示进度并允许取消
+    m_encodeJob = new TextEncodeJob(filePath, this);
+    m_encodeProgress = new QProgressDialog("正在编码...", "取消", 0, 100, this);
+    m_encodeProgress->setWindowTitle("文本文件编码");
+    m_encodeProgress->setWindowModality(Qt::WindowModal);
+    m_encodeProgress->setMinimumDuration(300);
+    m_encodeProgress->setAutoClose(false);
+    m_encodeProgress->setAutoReset(false);
+    m_encodeProgress->setValue(0);
+    
+    // 任务在工作线程里只更新原子计数，界面每 100ms 读一次；定时器随对话框销毁
+    QProgressDialog *progress = m_encodeProgress;
+    TextEncodeJob *job = m_encodeJob;
+    QTimer *poll = new QTimer(progress);
+    connect(poll, &QTimer::timeout, progress, [progress, job]() {
+        progress->setLabelText(job->phaseText() + "...");
+        progress->setValue(job->percent());
+    });
+    poll->start(100);
+    connect(m_encodeProgress, &QProgressDialog::canceled, m_encodeJob, &TextEncodeJob::cancel);
+    connect(m_encodeJob, &QThread::finished, this, &TextEncodeDecodeWindow::onEncodeTextFileFinished);
+    encodeTextFileButton->setEnabled(false);
+    m_encodeJob->start();
+}
+
+void TextEncodeDecodeWindow::onEncodeTextFileFinished() {
+    TextEncodeJob *job = m_encodeJob;
+    m_encodeJob = nullptr;
+    m_encodeProgress->deleteLater();
+    m_encodeProgress = nullptr;
+    encodeTextFileButton->setEnabled(true);
+    job->deleteLater();
+    
+    if (job->isCanceled()) return;
+    if (!job->succeeded()) {
+        QMessageBox::warning(this, "警告", job->errorString());
         return;
     }
     
-    // 读取整个文件
-    QByteArray content = file.readAll();
-    file.close();
-    
-    // 将文件内容转换为字符串
-    QString text = QString::fromUtf8(content);
-    
-    // 统计字符频率
-    m_characterFrequency.clear();
-    for (QChar c : text) {
-        m_characterFrequency[c]++;
-    }
-    
-    // 调用后端API进行编码
-    std::string encodedData = backend_api::encodeTextUtf8(text.toStdString());
+    const QString filePath = job->filePath();
+    const std::string &encodedData = job->encoded();
+    // 建树过程随编码一起算好，直接交给可视化
+    std::swap(m_huffmanTrace, job->trace());
 if (!encodedData.empty()) {
     encodeResultEdit->setPlainText(QString::fromStdString(encodedData));
     currentEncodedText = encodedData;
     
     // 计算压缩率
-    double originalSize = content.size();
+    double originalSize = job->originalSize();
     
     // 分离编码表和实际编码数据（查找最后一个|字符作为分隔符）
     size_t separatorPos = encodedData.rfind('|');
@@ -476,81 +470,117 @@ void TextEncodeDecodeWindow::onSaveDecodedTextClicked() {
 
 // ==================== 哈夫曼树可视化相关函数 ====================
 
+namespace {
+
+const QColor kLeafColor(100, 150, 240);
+const QColor kMergedColor(180, 180, 180);
+
+QBrush internalNodeBrush()
+{
+    QLinearGradient gradient(-30, -30, 30, 30);
+    gradient.setColorAt(0, QColor(140, 220, 180));
+    gradient.setColorAt(1, QColor(80, 180, 120));
+    return QBrush(gradient);
+}
+
+// 尚未合并时的画刷：叶子为蓝色，内部节点为绿色渐变
+QBrush nodeBrush(int id, int leafCount)
+{
+    return id < leafCount ? QBrush(kLeafColor) : internalNodeBrush();
+}
+
+} // namespace
+
 void TextEncodeDecodeWindow::prepareHuffmanNodes()
 {
     // 停止当前播放
     m_huffmanTimer->stop();
     m_playBtn->setText(tr("Play"));
     
+    // 先停止动画：它持有的图元指针会随场景一起被删除
+    m_huffmanAnimator.clear();
+    
     // 清理场景
     m_huffmanScene->clear();
-    m_huffmanItemMap.clear();
-    m_huffmanEdgeItems.clear();
-    m_activeAnims.clear();
-    
-    // 转换字符频率为哈夫曼树所需的格式
-    m_huffmanItems.clear();
-    for (auto it = m_characterFrequency.constBegin(); it != m_characterFrequency.constEnd(); ++it) {
-        QString label;
-        if (it.key() == '\n') {
+    m_huffmanNodeItems.clear();
+    
+    // 所有边由一个图元绘制（clear() 已删除旧的）
+    m_huffmanEdgeItem = new HuffmanEdgeItem();
+    // 不标 0/1：后端按范式规则分配码字，沿建树时的左右走出的路径不是实际码字（见叶子的提示）
+    m_huffmanEdgeItem->setCurveStyle(QPointF(-30, 40), QPointF(30, -40), false);
+    m_huffmanScene->addItem(m_huffmanEdgeItem);
+    m_huffmanAnimator.setEdgeItem(m_huffmanEdgeItem);
+    
+    // 还没有编码过文本时，用示例数据演示
+    if (m_huffmanTrace.leaves.empty()) {
+        std::string sample;
+        const std::pair<char, int> counts[] = {{'A', 45}, {'B', 13}, {'C', 12}, {'D', 16}, {'E', 9}, {'F', 5}};
+        for (const auto &c : counts) sample.append(c.second, c.first);
+        backend_api::encodeTextUtf8(sample, backend_api::CodecMode::Huffman, &m_huffmanTrace);
+    }
+    const int leafCount = int(m_huffmanTrace.leaves.size());
+    
+    // 创建叶子节点（每个节点一个自绘图元，按缩放决定细节）
+    m_huffmanNodeItems.reserve(2 * leafCount);
+    for (int i = 0; i < leafCount; ++i) {
+        const backend_api::HuffmanBuildTrace::Leaf &leaf = m_huffmanTrace.leaves[i];
+        QString label = QString::fromStdString(leaf.symbol);
+        if (label == "\n") {
             label = "\\n";
-        } else if (it.key() == '\t') {
+        } else if (label == "\t") {
             label = "\\t";
-        } else if (it.key() == ' ') {
+        } else if (label == " ") {
             label = "(空格)";
-        } else {
-            label = it.key();
         }
-        m_huffmanItems.append(qMakePair(label, it.value()));
-    }
-    
-    // 如果没有字符，使用默认示例数据
-    if (m_huffmanItems.isEmpty()) {
-        m_huffmanItems = {{"A",45},{"B",13},{"C",12},{"D",16},{"E",9},{"F",5}};
-    }
-    
-    // 创建初始节点
-    for (int i = 0; i < m_huffmanItems.size(); ++i) {
-        QString label = m_huffmanItems[i].first;
-        int weight = m_huffmanItems[i].second;
-        
-        QGraphicsItemGroup *group = new QGraphicsItemGroup();
-        QGraphicsEllipseItem *ellipse = new QGraphicsEllipseItem(-30, -30, 60, 60);
-        ellipse->setBrush(QBrush(QColor(100, 150, 240)));
-        ellipse->setPen(QPen(Qt::black));
+        const quint64 weight = leaf.count;
         
-        QGraphicsTextItem *labelText = new QGraphicsTextItem(label);
-        labelText->setDefaultTextColor(Qt::white);
-        labelText->setPos(-10, -10);
+        HuffmanNodeItem *node = new HuffmanNodeItem(label, weight);
+        m_huffmanScene->addItem(node);
         
-        QGraphicsTextItem *weightText = new QGraphicsTextItem(QString::number(weight));
-        weightText->setDefaultTextColor(Qt::black);
-        weightText->setPos(-10, 10);
-        
-        group->addToGroup(ellipse);
-        group->addToGroup(labelText);
-        group->addToGroup(weightText);
-        m_huffmanScene->addItem(group);
-        
-        group->setData(0, i);
-        group->setToolTip(QString("%1 : %2").arg(label).arg(weight));
-        m_huffmanItemMap.insert(i, group);
+        node->setData(0, i);
+        node->setToolTip(QString("%1 : %2\n编码: %3").arg(label).arg(weight).arg(QString::fromStdString(leaf.code)));
+        m_huffmanNodeItems.append(node);
     }
     
-    // 构建哈夫曼树
-    HuffmanBuilder builder(m_huffmanItems);
-    m_huffmanSteps = builder.buildSteps();
+    // 合并序列直接来自后端编码器，与实际码表是同一棵树
     m_currentHuffmanStep = 0;
+    m_huffmanLayout.reset(leafCount);
+    for (int i = 0; i < huffmanStepCount(); ++i) {
+        const backend_api::HuffmanBuildTrace::Merge &m = m_huffmanTrace.merges[i];
+        m_huffmanLayout.addMerge(m.left, m.right, leafCount + i);
+    }
+    
+    // 父节点也一次建好，合并前隐藏；之后前进、后退、拖动都只切换状态
+    for (int i = 0; i < huffmanStepCount(); ++i) {
+        const int parentId = leafCount + i;
+        const quint64 weight = m_huffmanTrace.merges[i].weight;
+        HuffmanNodeItem *parentNode = new HuffmanNodeItem(QString(), weight);
+        parentNode->setBrush(internalNodeBrush());
+        // 子树形状在合并时就已确定，缩小后按它画聚合图形
+        parentNode->setSubtreeExtent(m_huffmanLayout.subtreeRect(parentId, 100.0));
+        parentNode->setVisible(false);
+        m_huffmanScene->addItem(parentNode);
+        
+        parentNode->setData(0, parentId);
+        parentNode->setToolTip(QString("Weight: %1").arg(weight));
+        m_huffmanNodeItems.append(parentNode);
+    }
+    
+    {
+        QSignalBlocker blocker(m_stepSlider);
+        m_stepSlider->setRange(0, huffmanStepCount());
+        m_stepSlider->setValue(0);
+    }
+    m_stepLabel->setText(QString("0 / %1").arg(huffmanStepCount()));
     
     // 初始布局
-    layoutAndAnimateHuffman(0);
+    layoutAndAnimateHuffman(0, true);
 }
 
 void TextEncodeDecodeWindow::onHuffmanStep()
 {
-    if (m_currentHuffmanStep >= m_huffmanSteps.size()) return;
-    performHuffmanStep(m_huffmanSteps[m_currentHuffmanStep]);
-    m_currentHuffmanStep++;
+    if (m_currentHuffmanStep >= huffmanStepCount()) return;
+    seekHuffmanStep(m_currentHuffmanStep + 1, true);
 }
 
 void TextEncodeDecodeWindow::onHuffmanPlayPause()
@@ -559,9 +589,8 @@ void TextEncodeDecodeWindow::onHuffmanPlayPause()
         m_huffmanTimer->stop();
         m_playBtn->setText(tr("Play"));
     } else {
-        if (m_currentHuffmanStep >= m_huffmanSteps.size()) {
-            m_currentHuffmanStep = 0;
-            prepareHuffmanNodes();
+        if (m_currentHuffmanStep >= huffmanStepCount()) {
+            seekHuffmanStep(0, true);
         }
         m_huffmanTimer->start(1000);
         m_playBtn->setText(tr("Pause"));
@@ -572,19 +601,24 @@ void TextEncodeDecodeWindow::onHuffmanReset()
 {
     m_huffmanTimer->stop();
     m_playBtn->setText(tr("Play"));
-    m_currentHuffmanStep = 0;
-    prepareHuffmanNodes();
+    // 步骤与布局都已预先算好，回到第 0 步即可，不必重新建树
+    seekHuffmanStep(0, true);
 }
 
 void TextEncodeDecodeWindow::autoplayHuffmanStep()
 {
-    if (m_currentHuffmanStep >= m_huffmanSteps.size()) {
+    if (m_currentHuffmanStep >= huffmanStepCount()) {
         m_huffmanTimer->stop();
         m_playBtn->setText(tr("Play"));
         return;
     }
-    performHuffmanStep(m_huffmanSteps[m_currentHuffmanStep]);
-    m_currentHuffmanStep++;
+    seekHuffmanStep(m_currentHuffmanStep + 1, true);
+}
+
+void TextEncodeDecodeWindow::onHuffmanSeek(int step)
+{
+    // 拖动时直接跳到目标状态，不播放动画
+    seekHuffmanStep(step, false);
 }
 
 void TextEncodeDecodeWindow::onHuffmanZoomChanged(int value)
@@ -595,371 +629,97 @@ void TextEncodeDecodeWindow::onHuffmanZoomChanged(int value)
     m_huffmanView->scale(factor, factor);
 }
 
-void TextEncodeDecodeWindow::performHuffmanStep(const HuffStep &step)
+// 切换到执行 step 步之后的状态。
+// 第 s 步只影响三个节点：父节点在 s 之后可见，两个子节点在 s 之后变暗并挂到父节点下，
+// 所以只需处理当前步与目标步之间的那些合并，不用从第 0 步重放；布局仍是一次 O(n) 的 place()。
+void TextEncodeDecodeWindow::seekHuffmanStep(int step, bool animate)
 {
-    // 找到对应的图形项
-    int idA = step.a->id;
-    int idB = step.b->id;
-    QGraphicsItem *itemA = m_huffmanItemMap.value(idA, nullptr);
-    QGraphicsItem *itemB = m_huffmanItemMap.value(idB, nullptr);
-    
-    // 高亮选中的节点
-    if (itemA) {
-        auto group = static_cast<QGraphicsItemGroup*>(itemA);
-        foreach(QGraphicsItem *child, group->childItems()) {
-            if (auto e = qgraphicsitem_cast<QGraphicsEllipseItem*>(child)) {
-                e->setBrush(QBrush(QColor(240, 120, 100)));
-            }
-        }
-    }
-    
-    if (itemB) {
-        auto group = static_cast<QGraphicsItemGroup*>(itemB);
-        foreach(QGraphicsItem *child, group->childItems()) {
-            if (auto e = qgraphicsitem_cast<QGraphicsEllipseItem*>(child)) {
-                e->setBrush(QBrush(QColor(240, 120, 100)));
-            }
-        }
-    }
-    
-    // 创建父节点
-    int parentId = step.parent->id;
-    QGraphicsItemGroup *parentGroup = new QGraphicsItemGroup();
-    QGraphicsEllipseItem *parentEllipse = new QGraphicsEllipseItem(-30, -30, 60, 60);
-    
-    QLinearGradient gradient(-30, -30, 30, 30);
-    gradient.setColorAt(0, QColor(140, 220, 180));
-    gradient.setColorAt(1, QColor(80, 180, 120));
-    parentEllipse->setBrush(gradient);
-    parentEllipse->setPen(QPen(Qt::black));
-    
-    QGraphicsTextItem *parentWeightText = new QGraphicsTextItem(QString::number(step.parent->weight));
-    parentWeightText->setDefaultTextColor(Qt::black);
-    parentWeightText->setPos(-10, 0);
-    
-    parentGroup->addToGroup(parentEllipse);
-    parentGroup->addToGroup(parentWeightText);
-    m_huffmanScene->addItem(parentGroup);
-    
-    parentGroup->setData(0, parentId);
-    parentGroup->setToolTip(QString("Weight: %1").arg(step.parent->weight));
-    m_huffmanItemMap.insert(parentId, parentGroup);
-    
-    // 变暗已合并的节点
-    if (itemA) {
-        auto group = static_cast<QGraphicsItemGroup*>(itemA);
-        foreach(QGraphicsItem *child, group->childItems()) {
-            if (auto e = qgraphicsitem_cast<QGraphicsEllipseItem*>(child)) {
-                e->setBrush(QBrush(QColor(180, 180, 180)));
-            }
-        }
+    step = qBound(0, step, huffmanStepCount());
+    const int from = m_currentHuffmanStep;
+    const int leafCount = m_huffmanLayout.leafCount();
+    
+    for (int i = qMin(from, step); i < qMax(from, step); ++i) {
+        const backend_api::HuffmanBuildTrace::Merge &s = m_huffmanTrace.merges[i];
+        HuffmanNodeItem *parentNode = m_huffmanNodeItems.value(leafCount + i, nullptr);
+        HuffmanNodeItem *itemA = m_huffmanNodeItems.value(s.left, nullptr);
+        HuffmanNodeItem *itemB = m_huffmanNodeItems.value(s.right, nullptr);
+        if (!parentNode || !itemA || !itemB) continue;
+        
+        const bool merged = i < step;
+        // 新出现的父节点从两个子节点中间展开
+        if (merged && !parentNode->isVisible()) parentNode->setPos((itemA->pos() + itemB->pos()) / 2);
+        parentNode->setVisible(merged);
+        
+        // 变暗已合并的节点，并挂到父节点下（父节点折叠时它们不再单独绘制）
+        itemA->setBrush(merged ? QBrush(kMergedColor) : nodeBrush(s.left, leafCount));
+        itemA->setParentNode(merged ? parentNode : nullptr);
+        itemB->setBrush(merged ? QBrush(kMergedColor) : nodeBrush(s.right, leafCount));
+        itemB->setParentNode(merged ? parentNode : nullptr);
     }
+    m_currentHuffmanStep = step;
     
-    if (itemB) {
-        auto group = static_cast<QGraphicsItemGroup*>(itemB);
-        foreach(QGraphicsItem *child, group->childItems()) {
-            if (auto e = qgraphicsitem_cast<QGraphicsEllipseItem*>(child)) {
-                e->setBrush(QBrush(QColor(180, 180, 180)));
-            }
-        }
+    {
+        QSignalBlocker blocker(m_stepSlider);
+        m_stepSlider->setValue(step);
     }
+    m_stepLabel->setText(QString("%1 / %2").arg(step).arg(huffmanStepCount()));
     
     // 更新布局
-    layoutAndAnimateHuffman(m_currentHuffmanStep + 1);
+    layoutAndAnimateHuffman(step, animate);
 }
 
-// 修改layoutAndAnimateHuffman函数，使用QParallelAnimationGroup并在动画完成后绘制边
-void TextEncodeDecodeWindow::layoutAndAnimateHuffman(int stepsDone)
+// 布局由 HuffmanLayout 给出（每步 O(n)，不再重放全部合并），边在动画中跟随节点
+void TextEncodeDecodeWindow::layoutAndAnimateHuffman(int stepsDone, bool animate)
 {
-    // 构建轻量级布局节点
-    struct LNode { 
-        int id; 
-        int weight; 
-        LNode *left{nullptr}, *right{nullptr}; 
-        double x{0}, y{0}, width{0}; 
-    };
-    
-    QVector<LNode*> forest;
-    QMap<int, LNode*> nodeMap;
-    
-    // 创建初始叶子节点
-    for (int i = 0; i < m_huffmanItems.size(); ++i) {
-        LNode *ln = new LNode();
-        ln->id = i;
-        ln->weight = m_huffmanItems[i].second;
-        ln->width = 60;
-        nodeMap.insert(i, ln);
-        forest.append(ln);
-    }
-    
-    // 应用合并步骤
-    for (int i = 0; i < stepsDone && i < m_huffmanSteps.size(); ++i) {
-        const HuffStep &s = m_huffmanSteps[i];
-        int aId = s.a->id;
-        int bId = s.b->id;
-        int pId = s.parent->id;
-        
-        LNode *a = nodeMap.value(aId, nullptr);
-        LNode *b = nodeMap.value(bId, nullptr);
-        LNode *p = new LNode();
-        p->id = pId;
-        p->weight = s.parent->weight;
-        p->left = a;
-        p->right = b;
-        
-        // 从森林中移除a和b
-        for (int j = 0; j < forest.size(); ++j) {
-            if (forest[j] == a || forest[j] == b) {
-                forest.removeAt(j);
-                --j;
-            }
-        }
-        
-        forest.append(p);
-        nodeMap.insert(pId, p);
-    }
-    
-    // 计算子树宽度
-    std::function<double(LNode*)> computeWidth = [&](LNode* n)->double {
-        if (!n) return 0;
-        if (!n->left && !n->right) {
-            n->width = 60;
-            return n->width;
-        }
-        double leftW = computeWidth(n->left);
-        double rightW = computeWidth(n->right);
-        double spacing = 20;
-        n->width = leftW + rightW + spacing;
-        return n->width;
-    };
-    
-    // 计算深度
-    std::function<int(LNode*)> computeDepth = [&](LNode* n)->int {
-        if (!n) return 0;
-        if (!n->left && !n->right) return 0;
-        return 1 + qMax(computeDepth(n->left), computeDepth(n->right));
-    };
-    
-    // 分配位置，调整布局方向：根节点在上，叶子节点在下
-    std::function<void(LNode*, double, int, double)> assignPos = [&](LNode* n, double left, int depth, double levelHeight) {
-        if (!n) return;
-        if (!n->left && !n->right) {
-            n->x = left + n->width / 2;
-            n->y = 100 + depth * levelHeight;  // 调整y坐标计算方式
-            return;
-        }
-        
-        double spacing = 20;
-        double leftStart = left;
-        assignPos(n->left, leftStart, depth + 1, levelHeight);
-        assignPos(n->right, leftStart + (n->left ? n->left->width : 0) + spacing, depth + 1, levelHeight);
-        
-        // 父节点位置在子节点中间
-        double lx = n->left ? n->left->x : 0;
-        double rx = n->right ? n->right->x : lx;
-        n->x = (lx + rx) / 2.0;
-        n->y = 100 + depth * levelHeight;  // 调整y坐标计算方式
-    };
-    
-    // 计算宽度
-    for (LNode* r : forest) {
-        computeWidth(r);
-    }
-    
-    // 分配位置
-    double totalWidth = 0;
-    for (LNode* r : forest) {
-        totalWidth += r->width + 20;
-    }
-    if (totalWidth < 400) totalWidth = 400;
-    
-    // 计算场景中心和起始位置，使哈夫曼树居中显示
-    double sceneCenterX = 0;  // 场景的实际中心坐标是0，因为sceneRect设置为(-1000, -1000, 2000, 2000)
-    double left = sceneCenterX - totalWidth / 2;
+    // 森林整体居中：场景的实际中心坐标是0，因为sceneRect设置为(-1000, -1000, 2000, 2000)
+    double totalWidth = qMax(400.0, m_huffmanLayout.forestWidth(stepsDone));
     double levelHeight = 100.0;
-    for (LNode* r : forest) {
-        assignPos(r, left, 0, levelHeight);
-        left += r->width + 20;
-    }
+    // 根节点在上，叶子节点在下
+    m_huffmanLayout.place(stepsDone, -totalWidth / 2, 100, levelHeight, m_huffmanPositions);
     
-    // 动画
-    QVector<QAbstractAnimation*> anims;
-    int maxWeight = 1;
-    for (auto it = nodeMap.begin(); it != nodeMap.end(); ++it) {
-        if (it.value()) {
-            maxWeight = qMax(maxWeight, it.value()->weight);
-        }
-    }
+    // 边在动画过程中跟随节点移动
+    drawHuffmanEdges(stepsDone);
     
-    // 使用QParallelAnimationGroup管理动画
-    QParallelAnimationGroup *parallelGroup = new QParallelAnimationGroup();
+    // 所有节点由同一条时间线驱动
+    m_huffmanAnimator.begin();
+    QRectF area;
     
-    for (auto it = nodeMap.begin(); it != nodeMap.end(); ++it) {
-        int id = it.key();
-        LNode* ln = it.value();
-        QGraphicsItem *g = m_huffmanItemMap.value(id, nullptr);
-        if (!g || !ln) continue;
-        
-        // 创建位置动画
-        QVariantAnimation *anim = new QVariantAnimation();
-        anim->setDuration(500);
-        anim->setStartValue(g->pos());
-        anim->setEndValue(QPointF(ln->x - g->boundingRect().center().x(), ln->y - g->boundingRect().center().y()));
-        anim->setEasingCurve(QEasingCurve::OutCubic);
-        connect(anim, &QVariantAnimation::valueChanged, [g](const QVariant& value) {
-            g->setPos(value.toPointF());
-        });
-        parallelGroup->addAnimation(anim);
+    for (int id = 0; id < m_huffmanPositions.size(); ++id) {
+        HuffmanNodeItem *g = m_huffmanNodeItems.value(id, nullptr);
+        if (!g) continue;
+        const QPointF &target = m_huffmanPositions[id];
+        area |= QRectF(g->pos(), target).normalized().adjusted(-1, -1, 1, 1);
+        if (animate) m_huffmanAnimator.addMove(g, target);
+        else g->setPos(target);
     }
     
-    // 在动画完成后绘制边
-    connect(parallelGroup, &QParallelAnimationGroup::finished, this, [this, parallelGroup, stepsDone]() {
-        // 更新边
-        clearHuffmanEdges();
-        drawHuffmanEdges(stepsDone);
-        
-        // 清理动画组
-        parallelGroup->deleteLater();
-    });
+    // 节点只在起止位置的并集内移动，边图元的包围盒在动画开始前一次设好
+    if (m_huffmanEdgeItem) m_huffmanEdgeItem->setArea(area);
     
     // 启动动画
-    parallelGroup->start();
-    
-    // 清理临时节点
-    for (LNode* r : forest) {
-        delete r; // 递归删除所有节点
-    }
-    
-    // 更新动画列表
-    m_activeAnims.clear();
-    m_activeAnims.append(parallelGroup);
+    m_huffmanAnimator.start();
 }
 
 void TextEncodeDecodeWindow::clearHuffmanEdges()
 {
-    for (QGraphicsItem* item : m_huffmanEdgeItems) {
-        m_huffmanScene->removeItem(item);
-        delete item;
-    }
-    m_huffmanEdgeItems.clear();
+    if (m_huffmanEdgeItem) m_huffmanEdgeItem->clear();
 }
 
 void TextEncodeDecodeWindow::drawHuffmanEdges(int stepsDone)
 {
-    // 清除现有的边
-    for (QGraphicsItem* edge : m_huffmanEdgeItems) {
-        m_huffmanScene->removeItem(edge);
-        delete edge;
-    }
-    m_huffmanEdgeItems.clear();
-
-    // 绘制当前步骤的边
-    for (int i = 0; i < stepsDone && i < m_huffmanSteps.size(); ++i) {
-        const HuffStep& step = m_huffmanSteps[i];
-        int parentId = step.parent->id;
-        int leftId = step.a->id;
-        int rightId = step.b->id;
-
-        QGraphicsItem* parentItem = m_huffmanItemMap.value(parentId);
-        QGraphicsItem* leftItem = m_huffmanItemMap.value(leftId);
-        QGraphicsItem* rightItem = m_huffmanItemMap.value(rightId);
-
-        if (parentItem && leftItem) {
-            QPointF parentPos = parentItem->pos();
-            QPointF leftPos = leftItem->pos();
-
-            // 计算贝塞尔曲线的控制点
-            QPointF controlParent = parentPos + QPointF(-30, 40);
-            QPointF controlLeft = leftPos + QPointF(30, -40);
-
-            // 创建贝塞尔曲线路径
-            QPainterPath path(parentPos);
-            path.cubicTo(controlParent, controlLeft, leftPos);
-
-            // 绘制曲线
-            QGraphicsPathItem* edgeItem = new QGraphicsPathItem(path);
-            QPen pen(Qt::black, 2);
-            edgeItem->setPen(pen);
-            edgeItem->setZValue(-1);
-            m_huffmanScene->addItem(edgeItem);
-            m_huffmanEdgeItems.append(edgeItem);
-
-            // 绘制箭头
-            QPointF dir = (leftPos - controlLeft);
-            double length = std::hypot(dir.x(), dir.y());
-            if (length > 0.1) {
-                // 手动归一化向量
-                QPointF normalizedDir = dir / length;
-                
-                QPointF arrowPoint1 = leftPos - normalizedDir * 12 - QPointF(-normalizedDir.y() * 6, normalizedDir.x() * 6);
-                QPointF arrowPoint2 = leftPos - normalizedDir * 12 - QPointF(normalizedDir.y() * 6, -normalizedDir.x() * 6);
-
-                QPolygonF arrowHead;
-                arrowHead << leftPos << arrowPoint1 << arrowPoint2;
-
-                QGraphicsPolygonItem* arrowItem = new QGraphicsPolygonItem(arrowHead);
-                arrowItem->setBrush(Qt::black);
-                arrowItem->setZValue(-1);
-                m_huffmanScene->addItem(arrowItem);
-                m_huffmanEdgeItems.append(arrowItem);
-            }
-
-            // 绘制0/1标签
-            QPointF midPoint = (controlParent + controlLeft) / 2;
-            QGraphicsTextItem* labelItem = new QGraphicsTextItem("0");
-            labelItem->setDefaultTextColor(Qt::red);
-            labelItem->setPos(midPoint.x() - 5, midPoint.y() - 10);
-            m_huffmanScene->addItem(labelItem);
-            m_huffmanEdgeItems.append(labelItem);
-        }
-
-        if (parentItem && rightItem) {
-            QPointF parentPos = parentItem->pos();
-            QPointF rightPos = rightItem->pos();
-
-            // 计算贝塞尔曲线的控制点
-            QPointF controlParent = parentPos + QPointF(30, 40);
-            QPointF controlRight = rightPos + QPointF(-30, -40);
-
-            // 创建贝塞尔曲线路径
-            QPainterPath path(parentPos);
-            path.cubicTo(controlParent, controlRight, rightPos);
-
-            // 绘制曲线
-            QGraphicsPathItem* edgeItem = new QGraphicsPathItem(path);
-            QPen pen(Qt::black, 2);
-            edgeItem->setPen(pen);
-            edgeItem->setZValue(-1);
-            m_huffmanScene->addItem(edgeItem);
-            m_huffmanEdgeItems.append(edgeItem);
-
-            // 绘制箭头
-            QPointF dir = (rightPos - controlRight);
-            double length = std::hypot(dir.x(), dir.y());
-            if (length > 0.1) {
-                // 手动归一化向量
-                QPointF normalizedDir = dir / length;
-                
-                QPointF arrowPoint1 = rightPos - normalizedDir * 12 - QPointF(-normalizedDir.y() * 6, normalizedDir.x() * 6);
-                QPointF arrowPoint2 = rightPos - normalizedDir * 12 - QPointF(normalizedDir.y() * 6, -normalizedDir.x() * 6);
-
-                QPolygonF arrowHead;
-                arrowHead << rightPos << arrowPoint1 << arrowPoint2;
-
-                QGraphicsPolygonItem* arrowItem = new QGraphicsPolygonItem(arrowHead);
-                arrowItem->setBrush(Qt::black);
-                arrowItem->setZValue(-1);
-                m_huffmanScene->addItem(arrowItem);
-                m_huffmanEdgeItems.append(arrowItem);
-            }
-
-            // 绘制0/1标签
-            QPointF midPoint = (controlParent + controlRight) / 2;
-            QGraphicsTextItem* labelItem = new QGraphicsTextItem("1");
-            labelItem->setDefaultTextColor(Qt::red);
-            labelItem->setPos(midPoint.x() - 5, midPoint.y() - 10);
-            m_huffmanScene->addItem(labelItem);
-            m_huffmanEdgeItems.append(labelItem);
-        }
+    if (!m_huffmanEdgeItem) return;
+    // 边图元按步序保存每步的两条边，只追加缺少的部分
+    if (m_huffmanEdgeItem->edgeCount() > 2 * stepsDone) m_huffmanEdgeItem->clear();
+    
+    // 当前步骤的边：left 画在左侧，right 画在右侧（只表示建树时的先后，不是码字位）
+    const int leafCount = m_huffmanLayout.leafCount();
+    for (int i = m_huffmanEdgeItem->edgeCount() / 2; i < stepsDone && i < huffmanStepCount(); ++i) {
+        const backend_api::HuffmanBuildTrace::Merge &step = m_huffmanTrace.merges[i];
+        HuffmanNodeItem* parentItem = m_huffmanNodeItems.value(leafCount + i, nullptr);
+        HuffmanNodeItem* leftItem = m_huffmanNodeItems.value(step.left, nullptr);
+        HuffmanNodeItem* rightItem = m_huffmanNodeItems.value(step.right, nullptr);
+        if (!parentItem || !leftItem || !rightItem) break;
+        m_huffmanEdgeItem->addEdge(parentItem, leftItem, false);
+        m_huffmanEdgeItem->addEdge(parentItem, rightItem, true);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,77 @@
+#include "textencodejob.h"
+#include <QFile>
+
+namespace {
+
+// 每次读取的块大小；块之间检查取消并汇报进度
+constexpr qint64 kReadChunk = 1 << 20;
+
+// 各阶段在总进度里占的区间
+struct PhaseRange {
+    int from;
+    int to;
+    const char *text;
+};
+
+PhaseRange phaseRange(int phase) {
+    switch (phase) {
+    case JobProgress::Reading:   return {0, 30, "读取文件"};
+    case JobProgress::Analyzing: return {30, 50, "统计频率"};
+    case JobProgress::Encoding:  return {50, 100, "编码"};
+    case JobProgress::Done:      return {100, 100, "完成"};
+    default:                     return {0, 0, "准备"};
+    }
+}
+
+} // namespace
+
+TextEncodeJob::TextEncodeJob(const QString &filePath, QObject *parent)
+    : QThread(parent), m_filePath(filePath)
+{
+}
+
+int TextEncodeJob::percent() const
+{
+    PhaseRange r = phaseRange(m_progress.phase.load(std::memory_order_relaxed));
+    return r.from + int((r.to - r.from) * m_progress.fraction());
+}
+
+QString TextEncodeJob::phaseText() const
+{
+    return QString::fromUtf8(phaseRange(m_progress.phase.load(std::memory_order_relaxed)).text);
+}
+
+void TextEncodeJob::run()
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        m_error = "无法打开文件！";
+        return;
+    }
+
+    // 文本模式读取（换行符转换）仍由 QFile 完成，进度按同样的标记汇报
+    const qint64 total = file.size();
+    QByteArray content;
+    content.reserve(total);
+    if (!progressBegin(&m_progress, JobProgress::Reading, (uint64_t)qMax<qint64>(total, 0))) return;
+    while (!file.atEnd()) {
+        QByteArray chunk = file.read(kReadChunk);
+        if (chunk.isEmpty()) break;
+        content.append(chunk);
+        if (!progressAt(&m_progress, (uint64_t)content.size())) return;
+    }
+    file.close();
+    m_originalSize = content.size();
+
+    // 经 QString 转一次，与原来界面线程上的处理一致（非法 UTF-8 序列被替换）
+    // 统计与编码阶段由后端更新 m_progress，取消时返回空串
+    m_encoded = backend_api::encodeTextUtf8(QString::fromUtf8(content).toStdString(),
+                                            backend_api::CodecMode::Huffman, &m_trace, &m_progress);
+    if (isCanceled()) return;
+    if (m_encoded.empty()) {
+        m_error = "编码失败！";
+        return;
+    }
+    progressDone(&m_progress);
+    m_succeeded = true;
+}